@@ -1,50 +1,428 @@
 #include "RCReader.h"
 
 //Enum to know to which interrupt a RCReader belongs to not make unnecessary calculations
-enum _ISR_Mappings {PCINT0_ISR, PCINT1_ISR, PCINT2_ISR};
+//The values are also used as index into the per port dispatch tables
+enum _ISR_Mappings {PCINT0_ISR, PCINT1_ISR, PCINT2_ISR, NUM_OF_PCINT_ISRS};
+
+#ifdef RCREADER_ENABLE_FILTERS
+//Number of pulses kept for the median filter
+#define RCR_FILTER_HISTORY 5
+
+//Glitch filter state of one measurement
+struct _RCReaderFilter
+{
+    uint16_t history[RCR_FILTER_HISTORY];   //last accepted pulses, used as ring buffer
+    uint16_t maxDelta;                      //0 disables the spike rejection
+    uint8_t newest;                         //index of the newest pulse in history
+    uint8_t count;                          //number of valid entries in history
+    uint8_t mode;                           //RCRFilterMode
+    uint8_t rejected;                       //number of spikes rejected in a row
+};
+#endif
+
+#ifdef RCREADER_ENABLE_STATS
+//Counters of one measurement, the values that can be calculated from them are only calculated by RCReader::getStats
+struct _RCReaderStats
+{
+    uint32_t edgeCount;
+    uint16_t minimumWidth;      //0 until the first pulse was measured
+    uint16_t maximumWidth;
+    uint16_t framePeriod;
+    uint16_t impossibleTransitions;
+};
+#endif
+
+//Failsafe state of one measurement, see RCReader::setFailsafe
+struct _RCReaderFailsafe
+{
+    uint16_t ticks;             //timeout in ticks of the failsafe timer, 0 disables the failsafe
+    uint16_t value;             //0 passes on the last measured value
+    uint8_t recoveryPulses;     //pulses needed to leave the failsafe again
+    uint8_t recoveryCount;      //pulses received since the signal came back
+    bool active;
+};
 
 //Struct that hold all information for one RCReader instance.
 //This cannot be stored in the object itself because the logic of the ISR needs access to these variables.
 struct _RCReaderObject
 {
     uint8_t attatchedPin;
+    uint8_t pinMask;    //bit of the pin inside the port state that is passed to the ISR
     bool lastState;
-    uint32_t lastMicros;
+    RCRTimestamp lastTimestamp;     //time of the last rising edge
     uint16_t currentValue;
     _ISR_Mappings assignedISR;
+    _RCReaderPPMData* ppm;          //NULL for PWM readers, decoding state of the channels for PPM readers
+    uint8_t updateCount;            //counted up for every completed measurement (PWM) or frame (PPM)
+    uint8_t refCount;               //number of RCReader instances that share this measurement, 0 for unused slots
+    uint8_t nextFree;               //next slot of the free list, only valid while the slot is unused
+    uint16_t age;                   //ticks of the failsafe timer since the last rising edge, counted up by its ISR
+    _RCReaderFailsafe failsafe;
+#ifdef RCREADER_ENABLE_FILTERS
+    _RCReaderFilter filter;
+#endif
+#ifdef RCREADER_ENABLE_STATS
+    _RCReaderStats stats;
+#endif
 };
 
-// Initialize the array to all NULL pointers which signal the end of the array
-// New objects get allocated in memmory at runtime and their address is then added to the end of the array
-_RCReaderObject* _AllRCReaders[TOTAL_NUM_OF_PC_INTERRUPTS] = {NULL};
+//slot number of readers whose initialization failed
+#define RCR_INVALID_SLOT (TOTAL_NUM_OF_PC_INTERRUPTS + 1)
+//Compare match A of Timer0 happens once per overflow of the timer that is running for millis(), so every 1.024ms.
+//It is used as tick for the timeout and failsafe detection.
+#define RCR_TICK_INTERRUPT_MASK (1 << OCIE0A)
+//value of _RCReaderPPMData::currentChannel while no sync gap was detected
+#define RCR_PPM_NOT_SYNCED 0xFF
 
-RCReader::RCReader(RCReaderPin PinToAttach, uint16_t timeoutInMilliseconds, uint16_t validMinimumValue, uint16_t validMaximumValue, bool holdLastValueOnFailure)
+//Statically allocated storage for all measurements, so no heap memory is used.
+//Unused slots are linked together in a free list starting at _RCReaderFreeHead. The list is built on the first attach
+//because global RCReader instances are constructed before the main program starts.
+_RCReaderObject _RCReaderPool[TOTAL_NUM_OF_PC_INTERRUPTS];
+uint8_t _RCReaderFreeHead = RCR_INVALID_SLOT;
+bool _RCReaderPoolReady = false;
+
+//Counted up by the decoding logic after it changed the values of any reader and by the tick interrupt after it aged them.
+//Readers read the counter, copy their values and read the counter again. If the two reads differ the copy is repeated.
+//This gives consistent multi byte copies without disabling interrupts: the main loop can not run while an ISR is running,
+//so an ISR that changed values during the copy has always incremented the counter before the second read.
+//16 bit reads of the counter can tear on the AVR, but an increment by 1 always changes the low byte,
+//so a read that mixes the bytes of the old and the new value never equals the new value.
+volatile uint16_t _RCReaderSequence = 0;
+//The values read between the two reads of _RCReaderSequence are not volatile, so without a barrier the compiler
+//is free to move their loads in front of the first read or behind the second one, which would defeat the check.
+#define RCR_SEQUENCE_BARRIER() asm volatile("" ::: "memory")
+
+//Optional callback that is called once all readers in _RCReaderFrameMask got a new value (one complete receiver frame).
+//_RCReaderUpdatedMask collects the slots that were updated since the last complete frame.
+//_RCReaderFrameCallbackOwner is the group that registered the callback, so only that group removes it again.
+void (*_RCReaderFrameCallback)(void) = NULL;
+RCReaderGroup* _RCReaderFrameCallbackOwner = NULL;
+uint32_t _RCReaderFrameMask = 0;
+volatile uint32_t _RCReaderUpdatedMask = 0;
+
+//One entry of a per port dispatch table: the bit of the pin inside the port state and the slot in _RCReaderPool it belongs to
+struct _PortDispatchEntry
+{
+    uint8_t bitmask;
+    uint8_t slot;
+};
+
+//Dispatch tables for every PCINT port. They are rebuilt on every attach and detach so the ISRs
+//only have to look at the readers of their own port instead of walking the whole _RCReaderPool.
+//Readers of the same pin share one slot, so there can be at most one entry per pin of the port.
+_PortDispatchEntry _PortDispatchTable[NUM_OF_PCINT_ISRS][8];
+uint8_t _PortDispatchCount[NUM_OF_PCINT_ISRS] = {0};
+//Port state seen by the last interrupt of each port. XORing it with the new state gives the pins that actually toggled.
+uint8_t _PortLastState[NUM_OF_PCINT_ISRS] = {0};
+
+#ifdef RCREADER_ENABLE_STATS
+//Counters of the pin change interrupts. The ISR time is counted in ticks of the stats counter and converted by RCReader::getPortStats.
+struct _PortStats
+{
+    uint32_t isrCount;
+    uint32_t isrTicks;
+    _RCRStatsTicks maxIsrTicks;
+    uint16_t missedEdges;
+};
+_PortStats _PortStatsTable[NUM_OF_PCINT_ISRS];
+#endif
+
+#if RCREADER_TIMESTAMP_TIMER != 0
+volatile uint16_t _RCReaderTimerOverflows = 0;
+
+ISR(_RCR_TIMER_REG(TIMER, _OVF_vect))
+{
+    _RCReaderTimerOverflows++;
+}
+#endif
+
+#ifdef RCREADER_DEFERRED_DECODE
+//One queued pin change. The port number has the bit RCR_EDGE_GAP set if pin changes were dropped right before this one.
+struct _EdgeRecord
+{
+    uint16_t time;      //lower 16 bits of the timestamp
+    uint8_t port;
+    uint8_t pinStates;
+};
+#define RCR_EDGE_GAP 0x80
+
+//Single producer (ISRs) single consumer (RCReader::poll) ring buffer.
+//The head is only written by the ISRs and the tail only by poll, so both sides work without disabling interrupts.
+volatile _EdgeRecord _EdgeQueue[RCREADER_EDGE_QUEUE_SIZE];
+volatile uint8_t _EdgeQueueHead = 0;
+volatile uint8_t _EdgeQueueTail = 0;
+//set by the ISRs if a pin change had to be dropped, cleared with the next record that fits into the queue again
+volatile bool _EdgeQueueGap = false;
+//Bit per port whose _PortLastState is unknown after a gap. The next record of the port only sets the state, its pin changes are not decoded.
+uint8_t _PortResyncMask = 0;
+#endif
+
+#ifdef RCREADER_ENABLE_TRACE
+//One record of the trace buffer. The layout is the same as in the dumped trace, see extras/trace/README.md
+struct _TraceRecord
+{
+    uint16_t delta;     //ticks since the previous pin change
+    uint8_t port;
+    uint8_t pinStates;
+};
+//Port number of a record that adds its delta * 0x10000 ticks to the delta of the next record
+#define RCR_TRACE_PAUSE 0x0F
+#define RCR_TRACE_VERSION 1
+//Bits of the flags in the trace header
+#define RCR_TRACE_WRAPPED 0x01      //the oldest records were overwritten
+#define RCR_TRACE_CONTINUOUS 0x02   //recorded with startTrace(true)
+
+//The trace is only written by the ISRs while _TraceActive is set and only read by the main loop while it is not
+_TraceRecord _TraceBuffer[RCREADER_TRACE_SIZE];
+uint16_t _TraceHead = 0;        //next record that is written
+uint16_t _TraceLength = 0;
+uint16_t _TraceDropped = 0;     //pin changes that did not fit into the buffer anymore
+volatile bool _TraceActive = false;
+bool _TraceContinuous = false;
+bool _TraceWrapped = false;
+RCRTimestamp _TraceLastTime;
+uint8_t _TraceStartStates[NUM_OF_PCINT_ISRS];   //pin states of all ports when the recording started
+#endif
+
+//Reads the state of all pins of one PCINT port in the same bit layout the ISRs are using
+static inline uint8_t _readPortState(_ISR_Mappings port)
+{
+    switch(port)
+    {
+        case PCINT0_ISR:
+            return PINB;
+        case PCINT1_ISR:
+            //pin 0 (PE0) is not on the same port as all other pins of this interrupt, so it is moved to the unused bit 7 of PORTJ
+            return (PINJ & 0x7F) | ((PINE & 0x01) << 7);
+        default:
+            return PINK;
+    }
+}
+
+//PCMSK register of a PCINT port
+static inline volatile uint8_t* _pinChangeMaskRegister(_ISR_Mappings port)
+{
+    switch(port)
+    {
+        case PCINT0_ISR:
+            return &PCMSK0;
+        case PCINT1_ISR:
+            return &PCMSK1;
+        default:
+            return &PCMSK2;
+    }
+}
+
+//Rebuilds the dispatch tables of all ports from the slots that are in use.
+//Must be called with interrupts disabled so an ISR never sees a half written table.
+static void _rebuildDispatchTables()
+{
+    for(uint8_t port = 0; port < NUM_OF_PCINT_ISRS; port++)
+    {
+        _PortDispatchCount[port] = 0;
+    }
+    for(uint8_t i = 0; i < TOTAL_NUM_OF_PC_INTERRUPTS; i++)
+    {
+        if(_RCReaderPool[i].refCount != 0)
+        {
+            _ISR_Mappings port = _RCReaderPool[i].assignedISR;
+            _PortDispatchEntry* entry = &_PortDispatchTable[port][_PortDispatchCount[port]++];
+            entry->bitmask = _RCReaderPool[i].pinMask;
+            entry->slot = i;
+        }
+    }
+}
+
+#if RCREADER_OUTPUT_TIMER != 0
+#define RCR_NUM_OF_OUTPUTS 3
+//input pulse width that does not move an output
+#define RCR_OUTPUT_NEUTRAL 1500
+//Fast PWM mode 14 with ICR as top and a prescaler of 8: the timer counts in 0.5us and ICR sets the period to 20ms
+#define RCR_OUTPUT_PERIOD 40000
+#define RCR_OUTPUT_TCCRA (1 << _RCR_OUTPUT_REG(WGM, 1))
+#define RCR_OUTPUT_TCCRB ((1 << _RCR_OUTPUT_REG(WGM, 3)) | (1 << _RCR_OUTPUT_REG(WGM, 2)) | (1 << _RCR_OUTPUT_REG(CS, 1)))
+
+//Mixer of one RCReaderOutput. It is used by the ISRs, so it is only changed with interrupts disabled.
+struct _RCReaderOutputObject
+{
+    uint8_t inputs[RCREADER_OUTPUT_INPUTS];     //slots in _RCReaderPool, RCR_INVALID_SLOT if not used
+    int16_t weights[RCREADER_OUTPUT_INPUTS];    //7 fractional bits, 128 passes the input through
+    uint16_t minimum;
+    uint16_t maximum;
+    uint16_t center;
+};
+
+_RCReaderOutputObject _OutputTable[RCR_NUM_OF_OUTPUTS];
+//bits of the outputs every slot is mixed into, so the ISR only has to check one byte after a pulse
+uint8_t _OutputSlotMask[TOTAL_NUM_OF_PC_INTERRUPTS] = {0};
+//compare output mode bits of the outputs that are in use
+uint8_t _OutputComBits = 0;
+
+static volatile uint16_t* const _OutputRegisters[RCR_NUM_OF_OUTPUTS] = {&_RCR_OUTPUT_REG(OCR, A), &_RCR_OUTPUT_REG(OCR, B), &_RCR_OUTPUT_REG(OCR, C)};
+static const uint8_t _OutputComMasks[RCR_NUM_OF_OUTPUTS] = {(1 << _RCR_OUTPUT_REG(COM, A1)), (1 << _RCR_OUTPUT_REG(COM, B1)), (1 << _RCR_OUTPUT_REG(COM, C1))};
+#if RCREADER_OUTPUT_TIMER == 1
+static const uint8_t _OutputPins[RCR_NUM_OF_OUTPUTS] = {11, 12, 13};
+#elif RCREADER_OUTPUT_TIMER == 3
+static const uint8_t _OutputPins[RCR_NUM_OF_OUTPUTS] = {5, 2, 3};
+#elif RCREADER_OUTPUT_TIMER == 4
+static const uint8_t _OutputPins[RCR_NUM_OF_OUTPUTS] = {6, 7, 8};
+#elif RCREADER_OUTPUT_TIMER == 5
+static const uint8_t _OutputPins[RCR_NUM_OF_OUTPUTS] = {46, 45, 44};
+#else
+    #error RCREADER_OUTPUT_TIMER has to be 0, 1, 3, 4 or 5
+#endif
+
+//Arduino's init() reconfigures all timers after the global constructors ran, so the configuration is checked by the tick interrupt
+//and restored if needed. Must be called with interrupts disabled.
+static inline void _checkOutputTimer()
+{
+    if(_RCR_OUTPUT_REG(TCCR, A) != (RCR_OUTPUT_TCCRA | _OutputComBits) || _RCR_OUTPUT_REG(TCCR, B) != RCR_OUTPUT_TCCRB)
+    {
+        _RCR_OUTPUT_REG(TCCR, B) = 0;
+        _RCR_OUTPUT_REG(ICR, ) = RCR_OUTPUT_PERIOD - 1;
+        _RCR_OUTPUT_REG(TCCR, A) = RCR_OUTPUT_TCCRA | _OutputComBits;
+        _RCR_OUTPUT_REG(TCCR, B) = RCR_OUTPUT_TCCRB;
+    }
+}
+
+//Returns true if the pin is driven by a RCReaderOutput. Only timer 1 has compare outputs on pin change interrupt pins (11, 12 and 13).
+static bool _isActiveOutputPin(uint8_t pin)
+{
+    for(uint8_t i = 0; i < RCR_NUM_OF_OUTPUTS; i++)
+    {
+        if((_OutputComBits & _OutputComMasks[i]) != 0 && _OutputPins[i] == pin)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+//Limits the pulse width to the range of the output and writes it to the compare register.
+//The register is double buffered by the timer, so the new width is used from the next period on without glitches.
+static void _writeOutput(uint8_t output, int32_t microseconds)
+{
+    _RCReaderOutputObject* object = &_OutputTable[output];
+    if(microseconds < object->minimum)
+    {
+        microseconds = object->minimum;
+    } else if(microseconds > object->maximum)
+    {
+        microseconds = object->maximum;
+    }
+    uint8_t oldSREG = SREG;
+    noInterrupts(); //16 bit registers are written through the TEMP register of the timer, which is shared with the ISRs
+    *_OutputRegisters[output] = microseconds * 2;
+    SREG = oldSREG;
+}
+
+//Mixes the inputs of all outputs in the mask and writes the results. Called from the ISRs (or from poll in deferred mode)
+//right after a pulse completed, so the outputs do not wait for the main loop.
+static void _updateOutputs(uint8_t outputMask)
+{
+    for(uint8_t output = 0; output < RCR_NUM_OF_OUTPUTS; output++)
+    {
+        if((outputMask & (1 << output)) == 0)
+        {
+            continue;
+        }
+        _RCReaderOutputObject* object = &_OutputTable[output];
+        int32_t value = object->center;
+        for(uint8_t i = 0; i < RCREADER_OUTPUT_INPUTS; i++)
+        {
+            if(object->inputs[i] == RCR_INVALID_SLOT)
+            {
+                continue;
+            }
+            _RCReaderObject* reader = &_RCReaderPool[object->inputs[i]];
+            uint16_t input = (reader->failsafe.active && reader->failsafe.value != 0) ? reader->failsafe.value : reader->currentValue;
+            if(input != 0) //0 means no pulse was received yet
+            {
+                value += ((int32_t)object->weights[i] * ((int16_t)input - RCR_OUTPUT_NEUTRAL)) >> 7;
+            }
+        }
+        _writeOutput(output, value);
+    }
+}
+
+//Removes a slot that is freed from all mixers. Must be called with interrupts disabled.
+static void _removeOutputInput(uint8_t slot)
+{
+    for(uint8_t output = 0; output < RCR_NUM_OF_OUTPUTS; output++)
+    {
+        for(uint8_t i = 0; i < RCREADER_OUTPUT_INPUTS; i++)
+        {
+            if(_OutputTable[output].inputs[i] == slot)
+            {
+                _OutputTable[output].inputs[i] = RCR_INVALID_SLOT;
+            }
+        }
+    }
+    _OutputSlotMask[slot] = 0;
+}
+#endif
+
+//The tick interrupt is only enabled while a reader or an output needs it. Must be called with interrupts disabled.
+static void _updateTickInterrupt()
+{
+    bool needed = _PortDispatchCount[PCINT0_ISR] != 0 || _PortDispatchCount[PCINT1_ISR] != 0 || _PortDispatchCount[PCINT2_ISR] != 0;
+#if RCREADER_OUTPUT_TIMER != 0
+    needed = needed || _OutputComBits != 0;
+#endif
+    if(needed)
+    {
+        TIMSK0 |= RCR_TICK_INTERRUPT_MASK;
+    } else
+    {
+        TIMSK0 &= ~RCR_TICK_INTERRUPT_MASK;
+    }
+}
+
+//Registers a new _RCReaderObject for the pin and enables its pin change interrupt.
+//PWM readers of a pin that is already in use share the existing _RCReaderObject, so every edge is only measured once.
+//ppm has to be NULL for a normal PWM reader. Returns the slot in _RCReaderPool or RCR_INVALID_SLOT if there was no space left
+//or the pin is already used in a different mode.
+static uint8_t _attachRCReaderObject(RCReaderPin PinToAttach, _RCReaderPPMData* ppm)
 {
-    //checking first if there is still space in the array:
-    bool hasSpace = false;
-    //Find the last instance of RCReader in the array and append to the end of it:
+    if(!_RCReaderPoolReady)
+    {
+        for(uint8_t i = 0; i < TOTAL_NUM_OF_PC_INTERRUPTS; i++)
+        {
+            _RCReaderPool[i].nextFree = (i + 1 < TOTAL_NUM_OF_PC_INTERRUPTS) ? (i + 1) : RCR_INVALID_SLOT;
+        }
+        _RCReaderFreeHead = 0;
+        _RCReaderPoolReady = true;
+    }
+    //Find an existing measurement of the same pin:
     for(uint8_t i = 0; i < TOTAL_NUM_OF_PC_INTERRUPTS; i++)
     {
-        if(_AllRCReaders[i] == NULL)
+        if(_RCReaderPool[i].refCount != 0 && _RCReaderPool[i].attatchedPin == PinToAttach)
         {
-            //store the index number for future reference
-            _RCReaderIndexNum = i;
-            hasSpace = true;
-            break;
+            if(ppm != NULL || _RCReaderPool[i].ppm != NULL)
+            {
+                return RCR_INVALID_SLOT; //a PPM signal can not be shared
+            }
+            _RCReaderPool[i].refCount++; //only changed from the main loop, so no protection needed
+            return i;
         }
     }
-    if(hasSpace == false)
+    uint8_t interruptNum = _RCReaderPinToInterrupt(PinToAttach);
+    if(_RCReaderFreeHead == RCR_INVALID_SLOT || interruptNum == 255)
+    {
+        return RCR_INVALID_SLOT; //pool is already full or the pin has no pin change interrupt, return without doing anything
+    }
+#if RCREADER_OUTPUT_TIMER != 0
+    if(_isActiveOutputPin(PinToAttach))
     {
-        // set the index num to 1 higher than maximum to signal that tis RCReader instance is invalid
-        _RCReaderIndexNum = TOTAL_NUM_OF_PC_INTERRUPTS + 1; 
-        return; //array is already full return without doing anything
+        return RCR_INVALID_SLOT; //the pin is an output
     }
+#endif
 
     //Cunfiguring pin:
     pinMode(PinToAttach, INPUT);     //Configure pin as input
     digitalWrite(PinToAttach, INPUT_PULLUP); //Enable internal pull up
 
-    /* Configure Pin Change Interrupt and Mask for the current pin
+    /* Pin Change Interrupt and Mask register for the current pin
     Pin to register map:
     Register:   From:       To:
     ---------------------------
@@ -52,61 +430,159 @@ RCReader::RCReader(RCReaderPin PinToAttach, uint16_t timeoutInMilliseconds, uint
     PCMSK1      PCINT8      15
     PCMSK2      PCINT16     23
     */
-    
-    _ISR_Mappings assignedISR;
-    uint8_t interruptNum = _PinToInterruptMap(PinToAttach);
-    if(interruptNum >= 0 && interruptNum <= 7)
+    _ISR_Mappings assignedISR = (_ISR_Mappings)(interruptNum / 8);
+    uint8_t pinMask = _RCReaderPinStateMask(PinToAttach);
+
+    //take a slot from the free list and initialize it to a default state.
+    //The ISRs can not see it yet because it is not part of the dispatch tables.
+    uint8_t slot = _RCReaderFreeHead;
+    _RCReaderFreeHead = _RCReaderPool[slot].nextFree;
+    _RCReaderPool[slot] = _RCReaderObject{PinToAttach, pinMask, LOW, _RCReaderTimestamp(), 0, assignedISR, ppm, 0, 1, RCR_INVALID_SLOT};
+
+    //publish the slot to the ISRs in one step
+    uint8_t oldSREG = SREG;
+    noInterrupts();
+    *_pinChangeMaskRegister(assignedISR) |= (1 << (interruptNum % 8));
+    PCICR |= (1 << (PCIE0 + assignedISR));
+    //take over the current level of the new pin so its first interrupt is not mistaken for an edge
+    _PortLastState[assignedISR] = (_PortLastState[assignedISR] & ~pinMask) | (_readPortState(assignedISR) & pinMask);
+    _rebuildDispatchTables();
+    _updateTickInterrupt();
+    SREG = oldSREG;
+    return slot;
+}
+
+//Releases one user of a _RCReaderObject. The last user removes it from the processing and returns its slot to the free list.
+static void _detachRCReaderObject(uint8_t slot)
+{
+    if(slot >= TOTAL_NUM_OF_PC_INTERRUPTS)
+    {
+        return; //init failed, so there is nothing to free
+    }
+    _RCReaderObject* reader = &_RCReaderPool[slot];
+    if(reader->refCount == 0)
+    {
+        return; //already freed, a wrapped counter would leave the slot in the dispatch tables
+    }
+    if(--reader->refCount != 0)
+    {
+        return; //still used by other RCReader instances
+    }
+    //Slots are not compacted because the ISRs only walk the dispatch tables,
+    //so all other RCReader instances can keep their index number.
+    uint8_t oldSREG = SREG;
+    noInterrupts();
+    //disable the pin change interrupt of the pin, and of the whole port if no other pin is left
+    volatile uint8_t* pcmsk = _pinChangeMaskRegister(reader->assignedISR);
+    *pcmsk &= ~(1 << (_RCReaderPinToInterrupt((RCReaderPin)reader->attatchedPin) % 8));
+    if(*pcmsk == 0)
     {
-        PCMSK0 |= (1 << interruptNum);
-	    PCICR |= (1 << PCIE0);
-        assignedISR = PCINT0_ISR;
-    } else if(interruptNum >= 8 && interruptNum <= 15)
+        PCICR &= ~(1 << (PCIE0 + reader->assignedISR));
+    }
+    _RCReaderFrameMask &= ~((uint32_t)1 << slot);
+    _RCReaderUpdatedMask &= ~((uint32_t)1 << slot);
+    if(_RCReaderFrameMask == 0)
+    {
+        //all readers of the frame are gone, otherwise an empty mask would call the callback on every pulse of any other reader
+        _RCReaderFrameCallback = NULL;
+        _RCReaderFrameCallbackOwner = NULL;
+        _RCReaderUpdatedMask = 0;
+    }
+    _rebuildDispatchTables();
+    _updateTickInterrupt();
+#if RCREADER_OUTPUT_TIMER != 0
+    _removeOutputInput(slot);
+#endif
+    SREG = oldSREG;
+    reader->nextFree = _RCReaderFreeHead;
+    _RCReaderFreeHead = slot;
+}
+
+//Timeouts are counted in ticks of the failsafe timer (1.024ms), so they are converted once when they are configured
+static uint16_t _millisecondsToTicks(uint16_t milliseconds)
+{
+    uint16_t ticks = ((uint32_t)milliseconds * 125) >> 7;
+    return (ticks == 0 && milliseconds != 0) ? 1 : ticks; //0 would disable the timeout
+}
+
+//Timeout, failsafe and range checks shared by RCReader, RCReaderPPM and RCReaderGroup. See RCReader::getMicroseconds for the behavior.
+//The age and the failsafe state are kept up to date by the tick interrupt, so no time has to be calculated here.
+//They have to be copied together with the value, so all of them are from the same point in time.
+static RCRStatus _checkRCReaderValue(uint8_t slot, uint16_t currentValue, uint16_t age, bool failsafeActive, uint16_t timeoutTicks,
+                                      uint16_t validMinimum, uint16_t validMaximum, bool holdLastValidValue, uint16_t* lastValidValue, uint16_t* Value)
+{
+    _RCReaderObject* reader = &_RCReaderPool[slot];
+    if(failsafeActive || (age > timeoutTicks && timeoutTicks != 0)) //If enabled (not 0) check if the RCReader is still active.
+    {
+        //the RCReader was inactive for too long, so we have a timeout error. Pass the failsafe value if there is one
+        //or the last value and then return the timeout flag
+        *Value = (reader->failsafe.value != 0) ? reader->failsafe.value : currentValue;
+        return RCR_Timeout;
+    }else if((currentValue >= validMinimum && currentValue <= validMaximum) || 
+        (validMinimum == 0 && validMaximum == 0)) //check for invalid bounds if activated
     {
-        PCMSK1 |= (1 << (interruptNum % 8));
-	    PCICR |= (1 << PCIE1);
-        assignedISR = PCINT1_ISR;
-    }else if(interruptNum >= 16 && interruptNum <= 23)
+        // update the latest valid value and pass the current value to the specified location. Then return the OK flag
+        *Value = currentValue;
+        *lastValidValue = currentValue;
+        return RCR_OK;
+    } else
     {
-        PCMSK2 |= (1 << (interruptNum % 8));
-	    PCICR |= (1 << PCIE2);
-        assignedISR = PCINT2_ISR;
+        if(holdLastValidValue) //decide if the current value or the last valid value should be returned depending on the configuration
+                               //because there was a out of bounds error
+        {
+            *Value = *lastValidValue;
+        } else
+        {
+            *Value = currentValue;
+        }
+        return RCR_InvalidValue;
     }
+}
+
+//Copies the value, the update counter, the age and the failsafe state of one reader consistently, see _RCReaderSequence
+static inline void _readRCReaderObject(uint8_t slot, uint16_t* currentValue, uint8_t* updateCount, uint16_t* age, bool* failsafeActive)
+{
+    uint16_t sequence;
+    do
+    {
+        sequence = _RCReaderSequence;
+        RCR_SEQUENCE_BARRIER();
+        *currentValue = _RCReaderPool[slot].currentValue;
+        *updateCount = _RCReaderPool[slot].updateCount;
+        *age = _RCReaderPool[slot].age;
+        *failsafeActive = _RCReaderPool[slot].failsafe.active;
+        RCR_SEQUENCE_BARRIER();
+    } while(sequence != _RCReaderSequence);
+}
 
-    //allocate memory for the new struct entry and initialize its internal values to a default state:
-    _AllRCReaders[_RCReaderIndexNum] = new _RCReaderObject{PinToAttach, LOW, micros(), 0, assignedISR};
+RCReader::RCReader(RCReaderPin PinToAttach, uint16_t timeoutInMilliseconds, uint16_t validMinimumValue, uint16_t validMaximumValue, bool holdLastValueOnFailure)
+{
+    //store the index number for future reference. If there was no space left it is set to 1 higher than maximum to signal that this RCReader instance is invalid
+    _RCReaderIndexNum = _attachRCReaderObject(PinToAttach, NULL);
 
     //value validation is disabled by default.
     //disabled state is when min and max are at 0
     _validMinimum = validMinimumValue;
     _validMaximum = validMaximumValue;
     _holdLastValidValue = holdLastValueOnFailure;
+    _lastValidValue = 0;
+    _lastUpdateCount = 0;
 
     //timeout of 0 means disabled which is the default state
-    _timeout = timeoutInMilliseconds;
-
-    interrupts();//enable interrupts
+    _timeoutTicks = _millisecondsToTicks(timeoutInMilliseconds);
+#ifdef RCREADER_ENABLE_CALIBRATION
+    setCalibration(1000, 1500, 2000);
+#endif
 }
 
 RCReader::~RCReader()
 {
-    delete _AllRCReaders[_RCReaderIndexNum]; //free the allocated memory of the current object to not create a memory leak.
-    _AllRCReaders[_RCReaderIndexNum] = NULL; //set the current address to a NULL pointer to signal an empty space
-    //loop throug all elements wich come after the current element and shift them 1 location down the array to keep all objects in one row.
-    //this approach is more efficient in the ISR because processing of the array can be stopped once an NULL pointer is encountered.
-    for(uint8_t i = _RCReaderIndexNum + 1; i < TOTAL_NUM_OF_PC_INTERRUPTS; i++)
-    {
-        if(_AllRCReaders[i] == NULL) //If true this is our last element
-        {
-            _AllRCReaders[i - 1] = NULL;
-            break; //break the loop because this was the last element
-        }
-        _AllRCReaders[i - 1] = _AllRCReaders[i]; // if not hte last element shift them 1 location down
-    }
+    _detachRCReaderObject(_RCReaderIndexNum);
 }
 
 void RCReader::setTimeout(uint16_t timeoutInMilliseconds)
 {
-    _timeout = timeoutInMilliseconds;
+    _timeoutTicks = _millisecondsToTicks(timeoutInMilliseconds);
 }
 
 void RCReader::setValidRange(uint16_t validMinimumValue, uint16_t validMaximumValue, bool holdLastValueOnFailure)
@@ -120,7 +596,8 @@ int RCReader::getMicroseconds()
 {
     //siplified version of the getMicroseconds function if no error processing should be done
     uint16_t value;
-    if(getMicroseconds(&value) == RCR_OK || _holdLastValidValue)
+    RCRStatus status = getMicroseconds(&value);
+    if(status == RCR_OK || _holdLastValidValue || (status == RCR_Timeout && _RCReaderPool[_RCReaderIndexNum].failsafe.value != 0))
     {
         return value;
     } else 
@@ -132,171 +609,1164 @@ int RCReader::getMicroseconds()
 RCRStatus RCReader::getMicroseconds(uint16_t* Value)
 {
     //Check if init was successful
-    if(_RCReaderIndexNum == TOTAL_NUM_OF_PC_INTERRUPTS + 1)
+    if(_RCReaderIndexNum == RCR_INVALID_SLOT)
     {
         //return an error if not
         return RCR_InitFailed;
     }
-    uint32_t passedTime;
-    if(_AllRCReaders[_RCReaderIndexNum]->lastMicros > micros()) //check if an overflow occured
+    uint16_t currentValue;
+    uint16_t age;
+    bool failsafeActive;
+    _readRCReaderObject(_RCReaderIndexNum, &currentValue, &_lastUpdateCount, &age, &failsafeActive);
+    return _checkValue(currentValue, age, failsafeActive, Value);
+}
+
+#ifdef RCREADER_ENABLE_FILTERS
+void RCReader::setFilter(RCRFilterMode mode, uint16_t maxDelta)
+{
+    if(_RCReaderIndexNum == RCR_INVALID_SLOT)
+    {
+        return;
+    }
+    _RCReaderFilter* filter = &_RCReaderPool[_RCReaderIndexNum].filter;
+    uint8_t oldSREG = SREG;
+    noInterrupts(); //the filter is used by the ISR
+    filter->mode = mode;
+    filter->maxDelta = maxDelta;
+    filter->count = 0;
+    filter->rejected = 0;
+    SREG = oldSREG;
+}
+#endif
+
+void RCReader::setFailsafe(uint16_t timeoutInMilliseconds, uint16_t failsafeValue, uint8_t recoveryPulses)
+{
+    if(_RCReaderIndexNum == RCR_INVALID_SLOT)
+    {
+        return;
+    }
+    _RCReaderFailsafe* failsafe = &_RCReaderPool[_RCReaderIndexNum].failsafe;
+    uint8_t oldSREG = SREG;
+    noInterrupts(); //the failsafe is used by the ISRs
+    failsafe->ticks = _millisecondsToTicks(timeoutInMilliseconds);
+    failsafe->value = failsafeValue;
+    failsafe->recoveryPulses = recoveryPulses;
+    failsafe->active = false;
+    SREG = oldSREG;
+}
+
+bool RCReader::isFailsafe()
+{
+    if(_RCReaderIndexNum == RCR_INVALID_SLOT)
     {
-        passedTime = (UINT32_MAX - _AllRCReaders[_RCReaderIndexNum]->lastMicros) + micros(); //correct the overflow
-    } else
+        return false;
+    }
+    //single byte, so it can be read without any protection
+    return _RCReaderPool[_RCReaderIndexNum].failsafe.active;
+}
+
+#ifdef RCREADER_ENABLE_CALIBRATION
+void RCReader::setCalibration(uint16_t minimum, uint16_t center, uint16_t maximum, uint16_t deadband, uint8_t expo)
+{
+    if(minimum >= center || center >= maximum)
     {
-        passedTime = micros() - _AllRCReaders[_RCReaderIndexNum]->lastMicros; //no overflow, so calculation is done without any corrections
+        return;
     }
-    if(passedTime / 1000 > _timeout && _timeout != 0) //If enabled (not 0) check if the RCReader is still active.
+    if(expo > 100)
     {
-        //the RCReader was inactive for too long, so we have a timeout error. Pass the return value and then return the timeout flag
-        *Value = _AllRCReaders[_RCReaderIndexNum]->currentValue;
-        return RCR_Timeout;
-    }else if((_AllRCReaders[_RCReaderIndexNum]->currentValue >= _validMinimum && _AllRCReaders[_RCReaderIndexNum]->currentValue <= _validMaximum) || 
-        (_validMinimum == 0 && _validMaximum == 0)) //check for invalid bounds if activated
+        expo = 100;
+    }
+    uint16_t ranges[2] = {(uint16_t)(center - minimum), (uint16_t)(maximum - center)};
+    if(deadband >= ranges[0] || deadband >= ranges[1])
     {
-        // update the latest valid value and pass the current value to the specified location. Then return the OK flag
-        *Value = _AllRCReaders[_RCReaderIndexNum]->currentValue;
-        _lastValidValue = _AllRCReaders[_RCReaderIndexNum]->currentValue;
-        return RCR_OK;
-    } else
+        deadband = ((ranges[0] < ranges[1]) ? ranges[0] : ranges[1]) - 1;
+    }
+    _calibrationCenter = center;
+    _calibrationDeadband = deadband;
+    for(uint8_t side = 0; side < 2; side++)
     {
-        if(_holdLastValidValue) //decide if the current value or the last valid value should be returned depending on the configuration
-                                //because there was a out of bounds error
-        {
-            *Value = _lastValidValue;
-        } else
-        {
-            *Value = _AllRCReaders[_RCReaderIndexNum]->currentValue;
-        }
-        return RCR_InvalidValue;
+        //rounded up, so the end points are reached. Only ranges below 5us do not fit and are saturated
+        uint32_t scale = (((uint32_t)1024 << 8) + ranges[side] - deadband - 1) / (ranges[side] - deadband);
+        _calibrationScale[side] = (scale > 0xFFFF) ? 0xFFFF : scale;
+    }
+    //the curve is the same for both sides: linear part plus expo percent of x^3
+    for(uint8_t i = 0; i <= RCR_CALIBRATION_SEGMENTS; i++)
+    {
+        uint32_t x = (uint32_t)i * RCR_NORMALIZED_MAXIMUM / RCR_CALIBRATION_SEGMENTS;
+        uint32_t cubic = x * x / RCR_NORMALIZED_MAXIMUM * x / RCR_NORMALIZED_MAXIMUM;
+        _calibrationCurve[i] = (x * (100 - expo) + cubic * expo) / 100;
     }
+    _normalizedInput = 0;
+    _normalizedValue = _normalize(0);
 }
 
-void _calculateRCReaderCurrentValue(_ISR_Mappings currentISR, uint8_t pinStates)
+RCRStatus RCReader::getNormalized(int16_t* Value)
 {
-    //loop throug all instances of the RCReader
-    for(uint8_t i = 0; i < TOTAL_NUM_OF_PC_INTERRUPTS; i++)
+    uint16_t microseconds;
+    RCRStatus status = getMicroseconds(&microseconds);
+    if(status == RCR_InitFailed)
     {
-        //stop the loop if the current element is a NULL pointer -> last element
-        if(_AllRCReaders[i] == NULL)
-        {
-            return;
-        }
-        if(_AllRCReaders[i]->assignedISR == currentISR) //ISR matches, so calculate new values
-        {
-            _RCReaderObject* currentReader = _AllRCReaders[i];
-
-            bool currentPinState = LOW;
-            if(currentReader->attatchedPin == 0)// handle the special case of pin0
-            {
-                if((pinStates & 0x80) != 0)
-                {
-                    currentPinState = HIGH;
-                }
-            }else if((pinStates & digitalPinToBitMask(currentReader->attatchedPin)) != 0) // checking for not 0 because that saves a shifting operation
-            {
-                currentPinState = HIGH;
-            }
-            if(currentPinState == HIGH && currentReader->lastState == LOW) //Start measurement when the pin changes from LOW to HIGH
-            {
-                currentReader->lastMicros = micros();
-            } else if(currentPinState == LOW && currentReader->lastState == HIGH) //Stop measurement and calculate result when pin changes from HIGH to LOW
-            {
-                if(currentReader->lastMicros < micros())// no overflow
-                {
-                    currentReader->currentValue = micros() - currentReader->lastMicros;
-                }
-                else  // the variable overflowed so calculate the corrected value
-                {
-                    currentReader->currentValue = (UINT32_MAX - currentReader->lastMicros) + micros();
-                }
-            }
-            currentReader->lastState = currentPinState; // assinging the last state at every pin change in case the state machine gets messed up.
-        }
+        *Value = 0; //no pulse width was passed
+        return status;
+    }
+    if(microseconds == 0)
+    {
+        //no pulse was measured yet, which must not look like a full deflection
+        *Value = 0;
+        return (status == RCR_OK) ? RCR_InvalidValue : status;
+    }
+    if(microseconds != _normalizedInput)
+    {
+        _normalizedInput = microseconds;
+        _normalizedValue = _normalize(microseconds);
     }
+    *Value = _normalizedValue;
+    return status;
 }
 
-ISR(PCINT2_vect)
+int16_t RCReader::_normalize(uint16_t microseconds)
 {
-    #ifdef DISABLE_INTERRUPTS_DURING_CALCULAION
-        noInterrupts();
-    #endif
-    //reading in the state of the whole PORT at once to make sure the values are not changing while the calculation is happening:
-    _calculateRCReaderCurrentValue(PCINT2_ISR, PINK);
-    #ifdef DISABLE_INTERRUPTS_DURING_CALCULAION
-        interrupts();
-    #endif
+    uint8_t side = microseconds > _calibrationCenter;
+    uint16_t deviation = side ? microseconds - _calibrationCenter : _calibrationCenter - microseconds;
+    if(deviation <= _calibrationDeadband)
+    {
+        return 0;
+    }
+    //position on the curve from 0 to 1024, so the segment and the position inside of it are just bits of it
+    uint32_t position = ((uint32_t)(deviation - _calibrationDeadband) * _calibrationScale[side]) >> 8;
+    uint16_t value;
+    if(position >= 1024)
+    {
+        value = _calibrationCurve[RCR_CALIBRATION_SEGMENTS];
+    } else
+    {
+        uint8_t segment = position >> 6;
+        uint8_t fraction = position & 0x3F;
+        value = _calibrationCurve[segment] + (((_calibrationCurve[segment + 1] - _calibrationCurve[segment]) * fraction) >> 6);
+    }
+    return side ? (int16_t)value : -(int16_t)value;
 }
+#endif
 
-ISR(PCINT1_vect)
+bool RCReader::hasNewValue()
 {
-    #ifdef DISABLE_INTERRUPTS_DURING_CALCULAION
-        noInterrupts();
-    #endif
-    //unfortiunatly this is a special case bacause the pin 0 (PE0) is not on the same port as all other pins (PJ0-6) of this interrupt
-    uint8_t pinStates = PINJ & (0x7F); 
-    pinStates |= (digitalRead(0) << 7);
-    _calculateRCReaderCurrentValue(PCINT1_ISR, pinStates);
-    #ifdef DISABLE_INTERRUPTS_DURING_CALCULAION
-        interrupts();
-    #endif
+    if(_RCReaderIndexNum == RCR_INVALID_SLOT)
+    {
+        return false;
+    }
+    //single byte, so it can be read without any protection
+    return _RCReaderPool[_RCReaderIndexNum].updateCount != _lastUpdateCount;
 }
 
-ISR(PCINT0_vect)
+#ifdef RCREADER_ENABLE_STATS
+RCRStatus RCReader::getStats(RCRReaderStats* stats, bool reset)
 {
-    #ifdef DISABLE_INTERRUPTS_DURING_CALCULAION
-        noInterrupts();
-    #endif
-    _calculateRCReaderCurrentValue(PCINT0_ISR, PINB);
-    #ifdef DISABLE_INTERRUPTS_DURING_CALCULAION
-        interrupts();
-    #endif
+    if(_RCReaderIndexNum == RCR_INVALID_SLOT)
+    {
+        return RCR_InitFailed;
+    }
+    _RCReaderStats* counters = &_RCReaderPool[_RCReaderIndexNum].stats;
+    uint8_t oldSREG = SREG;
+    noInterrupts(); //the counters are written by the ISR
+    stats->edgeCount = counters->edgeCount;
+    stats->minimumWidth = counters->minimumWidth;
+    stats->maximumWidth = counters->maximumWidth;
+    stats->framePeriod = counters->framePeriod;
+    stats->impossibleTransitions = counters->impossibleTransitions;
+    if(reset)
+    {
+        *counters = _RCReaderStats{0, 0, 0, 0, 0};
+    }
+    SREG = oldSREG;
+    stats->jitter = stats->maximumWidth - stats->minimumWidth;
+    stats->frameRate = (stats->framePeriod != 0) ? (1000000UL + stats->framePeriod / 2) / stats->framePeriod : 0;
+    return RCR_OK;
 }
 
-uint8_t RCReader::_PinToInterruptMap(RCReaderPin pin)
-{
-    //translating the pin numbers to their PCINT number
-    //Doing it with a switch case saves memory because there is a lot of space in between which would be wasted memory
-    switch(pin)
-    {
-        case RCR_PIN_53:
-            return 0;
-        case RCR_PIN_52:
-            return 1;
-        case RCR_PIN_51:
-            return 2;
-        case RCR_PIN_50:
-            return 3;
-        case RCR_PIN_10:
-            return 4;
-        case RCR_PIN_11:
-            return 5;
-        case RCR_PIN_12:
-            return 6;
-        case RCR_PIN_13:
-            return 7;
-        case RCR_PIN_0:
-            return 8;
-        case RCR_PIN_15:
-            return 9;
-        case RCR_PIN_14:
-            return 10;
-        case RCR_PIN_A8:
-            return 16;
-        case RCR_PIN_A9:
-            return 17;
-        case RCR_PIN_A10:
-            return 18;
-        case RCR_PIN_A11:
-            return 19;
-        case RCR_PIN_A12:
-            return 20;
-        case RCR_PIN_A13:
-            return 21;
-        case RCR_PIN_A14:
-            return 22;
-        case RCR_PIN_A15:
-            return 23;
-        default:
-            return 255;
+RCRStatus RCReader::getPortStats(uint8_t port, RCRPortStats* stats, bool reset)
+{
+    if(port >= NUM_OF_PCINT_ISRS)
+    {
+        return RCR_InitFailed;
+    }
+    _PortStats* counters = &_PortStatsTable[port];
+    uint8_t oldSREG = SREG;
+    noInterrupts();
+    stats->isrCount = counters->isrCount;
+    stats->isrCycles = counters->isrTicks * RCR_STATS_CYCLES_PER_TICK;
+    stats->maxIsrCycles = counters->maxIsrTicks * RCR_STATS_CYCLES_PER_TICK;
+    stats->missedEdges = counters->missedEdges;
+    if(reset)
+    {
+        *counters = _PortStats{0, 0, 0, 0};
     }
-}
\ No newline at end of file
+    SREG = oldSREG;
+    return RCR_OK;
+}
+#endif
+
+RCRStatus RCReader::_checkValue(uint16_t currentValue, uint16_t age, bool failsafeActive, uint16_t* Value)
+{
+    return _checkRCReaderValue(_RCReaderIndexNum, currentValue, age, failsafeActive, _timeoutTicks, _validMinimum, _validMaximum,
+                               _holdLastValidValue, &_lastValidValue, Value);
+}
+
+RCReaderPPM::RCReaderPPM(RCReaderPin PinToAttach, uint16_t timeoutInMilliseconds, uint16_t validMinimumValue, uint16_t validMaximumValue, bool holdLastValueOnFailure)
+{
+    //nothing is decoded until the first sync gap was seen
+    _data.currentChannel = RCR_PPM_NOT_SYNCED;
+    _data.channelCount = 0;
+    _data.frameCounter = 0;
+    for(uint8_t i = 0; i < RCREADER_PPM_MAX_CHANNELS; i++)
+    {
+        _data.values[i] = 0;
+        _lastValidValues[i] = 0;
+    }
+    _validMinimum = validMinimumValue;
+    _validMaximum = validMaximumValue;
+    _holdLastValidValue = holdLastValueOnFailure;
+    _timeoutTicks = _millisecondsToTicks(timeoutInMilliseconds);
+    _RCReaderIndexNum = _attachRCReaderObject(PinToAttach, &_data);
+}
+
+RCReaderPPM::~RCReaderPPM()
+{
+    _detachRCReaderObject(_RCReaderIndexNum);
+}
+
+void RCReaderPPM::setTimeout(uint16_t timeoutInMilliseconds)
+{
+    _timeoutTicks = _millisecondsToTicks(timeoutInMilliseconds);
+}
+
+void RCReaderPPM::setValidRange(uint16_t validMinimumValue, uint16_t validMaximumValue, bool holdLastValueOnFailure)
+{
+    _validMinimum = validMinimumValue;
+    _validMaximum = validMaximumValue;
+    _holdLastValidValue = holdLastValueOnFailure;
+}
+
+int RCReaderPPM::getMicroseconds(uint8_t channel)
+{
+    uint16_t value;
+    RCRStatus status = getMicroseconds(channel, &value);
+    if(status == RCR_OK || (_holdLastValidValue && status != RCR_InitFailed))
+    {
+        return value;
+    } else 
+    {
+        return -1;
+    }
+}
+
+RCRStatus RCReaderPPM::getMicroseconds(uint8_t channel, uint16_t* Value)
+{
+    if(_RCReaderIndexNum == RCR_INVALID_SLOT || channel >= RCREADER_PPM_MAX_CHANNELS)
+    {
+        return RCR_InitFailed;
+    }
+    //the ISR can change the multi byte values at any time, see _RCReaderSequence
+    uint16_t currentValue;
+    uint8_t channelCount;
+    uint16_t age;
+    bool failsafeActive;
+    uint16_t sequence;
+    do
+    {
+        sequence = _RCReaderSequence;
+        RCR_SEQUENCE_BARRIER();
+        currentValue = _data.values[channel];
+        channelCount = _data.channelCount;
+        age = _RCReaderPool[_RCReaderIndexNum].age;
+        failsafeActive = _RCReaderPool[_RCReaderIndexNum].failsafe.active;
+        RCR_SEQUENCE_BARRIER();
+    } while(sequence != _RCReaderSequence);
+    if(channel >= channelCount) //the channel was not part of the last complete frame
+    {
+        *Value = _holdLastValidValue ? _lastValidValues[channel] : currentValue;
+        return RCR_InvalidValue;
+    }
+    return _checkRCReaderValue(_RCReaderIndexNum, currentValue, age, failsafeActive, _timeoutTicks, _validMinimum, _validMaximum,
+                               _holdLastValidValue, &_lastValidValues[channel], Value);
+}
+
+uint8_t RCReaderPPM::getChannelCount()
+{
+    return _data.channelCount;
+}
+
+uint16_t RCReaderPPM::getFrameCounter()
+{
+    uint16_t frameCounter;
+    uint16_t sequence;
+    do
+    {
+        sequence = _RCReaderSequence;
+        RCR_SEQUENCE_BARRIER();
+        frameCounter = _data.frameCounter;
+        RCR_SEQUENCE_BARRIER();
+    } while(sequence != _RCReaderSequence);
+    return frameCounter;
+}
+
+RCReaderGroup::RCReaderGroup()
+{
+    _channelCount = 0;
+    _holdLastValidValue = 0;
+    _pulseCount = 0;
+}
+
+RCReaderGroup::~RCReaderGroup()
+{
+    if(_RCReaderFrameCallbackOwner == this)
+    {
+        //the callback is meant for this group, other readers of its channels must not keep calling it
+        uint8_t oldSREG = SREG;
+        noInterrupts();
+        _RCReaderFrameCallback = NULL;
+        _RCReaderFrameCallbackOwner = NULL;
+        _RCReaderFrameMask = 0;
+        _RCReaderUpdatedMask = 0;
+        SREG = oldSREG;
+    }
+    for(uint8_t i = 0; i < _channelCount; i++)
+    {
+        _detachRCReaderObject(_slots[i]);
+    }
+}
+
+bool RCReaderGroup::_addChannel(uint8_t slot, uint16_t timeoutTicks, uint16_t validMinimumValue, uint16_t validMaximumValue, bool holdLastValueOnFailure)
+{
+    uint8_t channel = _channelCount++;
+    _slots[channel] = slot;
+    _validMinimum[channel] = validMinimumValue;
+    _validMaximum[channel] = validMaximumValue;
+    _lastValidValue[channel] = 0;
+    _timeoutTicks[channel] = timeoutTicks;
+    _lastUpdateCount[channel] = (slot != RCR_INVALID_SLOT) ? _RCReaderPool[slot].updateCount : 0;
+    if(holdLastValueOnFailure)
+    {
+        _holdLastValidValue |= (uint32_t)1 << channel;
+    }
+    return true;
+}
+
+bool RCReaderGroup::addChannel(RCReaderPin pin, uint16_t timeoutInMilliseconds, uint16_t validMinimumValue, uint16_t validMaximumValue, bool holdLastValueOnFailure)
+{
+    if(_channelCount >= TOTAL_NUM_OF_PC_INTERRUPTS)
+    {
+        return false;
+    }
+    return _addChannel(_attachRCReaderObject(pin, NULL), _millisecondsToTicks(timeoutInMilliseconds), validMinimumValue, validMaximumValue, holdLastValueOnFailure);
+}
+
+bool RCReaderGroup::add(RCReader& reader)
+{
+    if(_channelCount >= TOTAL_NUM_OF_PC_INTERRUPTS)
+    {
+        return false;
+    }
+    uint8_t slot = reader._RCReaderIndexNum;
+    if(slot != RCR_INVALID_SLOT)
+    {
+        _RCReaderPool[slot].refCount++; //the group is one more user of the measurement, so it stays valid without the reader
+    }
+    return _addChannel(slot, reader._timeoutTicks, reader._validMinimum, reader._validMaximum, reader._holdLastValidValue);
+}
+
+uint8_t RCReaderGroup::getChannelCount()
+{
+    return _channelCount;
+}
+
+uint16_t RCReaderGroup::_copyChannels(uint16_t* out, uint16_t* ages, bool* failsafe, uint8_t n)
+{
+    //copy the raw values and ages of all channels in one pass and start over if an ISR changed anything in between
+    uint8_t updateCounts[TOTAL_NUM_OF_PC_INTERRUPTS];
+    uint16_t sequence;
+    do
+    {
+        sequence = _RCReaderSequence;
+        RCR_SEQUENCE_BARRIER();
+        for(uint8_t i = 0; i < n; i++)
+        {
+            uint8_t slot = _slots[i];
+            if(slot != RCR_INVALID_SLOT)
+            {
+                out[i] = _RCReaderPool[slot].currentValue;
+                updateCounts[i] = _RCReaderPool[slot].updateCount;
+                ages[i] = _RCReaderPool[slot].age;
+                failsafe[i] = _RCReaderPool[slot].failsafe.active;
+            } else
+            {
+                ages[i] = 0;
+                failsafe[i] = false;
+            }
+        }
+        RCR_SEQUENCE_BARRIER();
+    } while(sequence != _RCReaderSequence);
+    //count the pulses the channels completed since they were read last, so the result only changes if the group got new values
+    for(uint8_t i = 0; i < n; i++)
+    {
+        if(_slots[i] != RCR_INVALID_SLOT)
+        {
+            _pulseCount += (uint8_t)(updateCounts[i] - _lastUpdateCount[i]);
+            _lastUpdateCount[i] = updateCounts[i];
+        }
+    }
+    return _pulseCount;
+}
+
+RCRStatus RCReaderGroup::_checkChannel(uint8_t channel, uint16_t age, bool failsafeActive, uint16_t* value)
+{
+    if(_slots[channel] == RCR_INVALID_SLOT)
+    {
+        *value = 0; //nothing was copied for the channel
+        return RCR_InitFailed;
+    }
+    bool hold = (_holdLastValidValue & ((uint32_t)1 << channel)) != 0;
+    return _checkRCReaderValue(_slots[channel], *value, age, failsafeActive, _timeoutTicks[channel], _validMinimum[channel], _validMaximum[channel],
+                               hold, &_lastValidValue[channel], value);
+}
+
+uint16_t RCReaderGroup::snapshot(uint16_t* out, RCRStatus* status, uint8_t n)
+{
+    if(n > _channelCount)
+    {
+        n = _channelCount;
+    }
+    uint16_t ages[TOTAL_NUM_OF_PC_INTERRUPTS];
+    bool failsafe[TOTAL_NUM_OF_PC_INTERRUPTS];
+    uint16_t sequence = _copyChannels(out, ages, failsafe, n);
+    //the checks work on the copies, so they can take as long as they need
+    for(uint8_t i = 0; i < n; i++)
+    {
+        status[i] = _checkChannel(i, ages[i], failsafe[i], &out[i]);
+    }
+    return sequence;
+}
+
+uint16_t RCReaderGroup::readAll(uint16_t* values, uint32_t* errorMask, uint32_t* timeoutMask)
+{
+    uint16_t ages[TOTAL_NUM_OF_PC_INTERRUPTS];
+    bool failsafe[TOTAL_NUM_OF_PC_INTERRUPTS];
+    uint16_t sequence = _copyChannels(values, ages, failsafe, _channelCount);
+    uint32_t errors = 0;
+    uint32_t timeouts = 0;
+    uint32_t bit = 1;
+    for(uint8_t i = 0; i < _channelCount; i++, bit <<= 1)
+    {
+        RCRStatus status = _checkChannel(i, ages[i], failsafe[i], &values[i]);
+        if(status != RCR_OK)
+        {
+            errors |= bit;
+            if(status == RCR_Timeout)
+            {
+                timeouts |= bit;
+            }
+        }
+    }
+    *errorMask = errors;
+    if(timeoutMask != NULL)
+    {
+        *timeoutMask = timeouts;
+    }
+    return sequence;
+}
+
+uint32_t RCReaderGroup::changedMask()
+{
+    uint32_t mask = 0;
+    for(uint8_t i = 0; i < _channelCount; i++)
+    {
+        //single byte, so it can be read without any protection
+        if(_slots[i] != RCR_INVALID_SLOT && _RCReaderPool[_slots[i]].updateCount != _lastUpdateCount[i])
+        {
+            mask |= (uint32_t)1 << i;
+        }
+    }
+    return mask;
+}
+
+void RCReaderGroup::setFrameCallback(void (*callback)(void), uint32_t channelMask)
+{
+    //translate the channel numbers of the group to the slots the ISR is working with
+    uint32_t frameMask = 0;
+    for(uint8_t i = 0; i < _channelCount; i++)
+    {
+        uint8_t slot = _slots[i];
+        if((channelMask & ((uint32_t)1 << i)) != 0 && slot != RCR_INVALID_SLOT)
+        {
+            frameMask |= (uint32_t)1 << slot;
+        }
+    }
+    uint8_t oldSREG = SREG;
+    noInterrupts(); //the callback and the masks are used by the ISRs
+    _RCReaderFrameCallback = (frameMask != 0) ? callback : NULL;
+    _RCReaderFrameCallbackOwner = (_RCReaderFrameCallback != NULL) ? this : NULL;
+    _RCReaderFrameMask = frameMask;
+    _RCReaderUpdatedMask = 0;
+    SREG = oldSREG;
+}
+
+//Restarts the age of a measurement on a rising edge.
+//In deferred mode this runs in the main loop, so the tick interrupt has to be blocked while the two bytes are written.
+static inline void _resetAge(_RCReaderObject* reader)
+{
+#ifdef RCREADER_DEFERRED_DECODE
+    uint8_t oldSREG = SREG;
+    noInterrupts();
+    reader->age = 0;
+    SREG = oldSREG;
+#else
+    reader->age = 0;
+#endif
+}
+
+//Counts the pulses after a signal loss and leaves the failsafe once enough of them were received
+static inline void _recoverFailsafe(_RCReaderFailsafe* failsafe)
+{
+#ifdef RCREADER_DEFERRED_DECODE
+    uint8_t oldSREG = SREG;
+    noInterrupts(); //the tick interrupt can activate the failsafe at the same time
+#endif
+    if(failsafe->active && ++failsafe->recoveryCount >= failsafe->recoveryPulses)
+    {
+        failsafe->active = false;
+    }
+#ifdef RCREADER_DEFERRED_DECODE
+    SREG = oldSREG;
+#endif
+}
+
+//Decodes one rising edge of a PPM sum signal.
+//The time between two rising edges is the value of one channel, this works for both signal polarities
+//because the constant pulse width only shifts all edges by the same amount. A gap longer than
+//RCREADER_PPM_SYNC_GAP marks the end of a frame.
+static inline void _decodePPMEdge(_RCReaderObject* reader, RCRTimestamp now)
+{
+    _RCReaderPPMData* ppm = reader->ppm;
+    uint32_t interval = _RCReaderTicksToMicros(now - reader->lastTimestamp);
+    reader->lastTimestamp = now;
+    _resetAge(reader);
+    if(interval >= RCREADER_PPM_SYNC_GAP)
+    {
+        if(ppm->currentChannel != RCR_PPM_NOT_SYNCED && ppm->currentChannel != 0)
+        {
+            ppm->channelCount = ppm->currentChannel;
+            ppm->frameCounter++;
+            reader->updateCount++;
+            _recoverFailsafe(&reader->failsafe);
+        }
+        ppm->currentChannel = 0;
+    } else if(ppm->currentChannel < RCREADER_PPM_MAX_CHANNELS)
+    {
+        ppm->values[ppm->currentChannel++] = interval;
+    } else
+    {
+        //more channels than expected or not synced yet, wait for the next sync gap
+        ppm->currentChannel = RCR_PPM_NOT_SYNCED;
+    }
+}
+
+#ifdef RCREADER_ENABLE_FILTERS
+static inline void _swap(uint16_t& a, uint16_t& b)
+{
+    uint16_t temp = a;
+    a = b;
+    b = temp;
+}
+
+//Median of 5 values with 6 comparisons. The smallest values are eliminated pairwise until the median is left.
+static inline uint16_t _median5(uint16_t a, uint16_t b, uint16_t c, uint16_t d, uint16_t e)
+{
+    if(a > b) _swap(a, b);
+    if(c > d) _swap(c, d);
+    if(a > c) { _swap(a, c); _swap(b, d); }
+    //a is smaller than 3 other values, so it can not be the median. Replace it by the last value
+    a = e;
+    if(a > b) _swap(a, b);
+    if(a > c) { _swap(a, c); _swap(b, d); }
+    return (b < c) ? b : c;
+}
+
+static inline uint16_t _median3(uint16_t a, uint16_t b, uint16_t c)
+{
+    if(a > b) _swap(a, b);
+    //a is the smaller one of the first two values, so the median is the smaller one of b and c unless that is smaller than a
+    uint16_t median = (b < c) ? b : c;
+    return (median > a) ? median : a;
+}
+
+//Runs a new pulse through the glitch filters. Works with integers only and takes the same time for every pulse.
+//Returns false if the pulse was rejected as spike, otherwise the filtered value is stored in width.
+static inline bool _filterPulse(_RCReaderFilter* filter, uint16_t* width)
+{
+    if(filter->mode == RCR_FILTER_NONE && filter->maxDelta == 0)
+    {
+        return true; //no filter configured, setFilter resets the history when one is enabled
+    }
+    if(filter->maxDelta != 0 && filter->count != 0)
+    {
+        uint16_t last = filter->history[filter->newest];
+        uint16_t delta = (*width > last) ? (*width - last) : (last - *width);
+        if(delta > filter->maxDelta && filter->rejected == 0)
+        {
+            filter->rejected++;
+            return false;
+        }
+    }
+    filter->rejected = 0;
+    filter->newest = (filter->newest + 1 < RCR_FILTER_HISTORY) ? (filter->newest + 1) : 0;
+    filter->history[filter->newest] = *width;
+    if(filter->count < RCR_FILTER_HISTORY)
+    {
+        filter->count++;
+    }
+
+    const uint16_t* h = filter->history;
+    if(filter->mode == RCR_FILTER_MEDIAN5 && filter->count >= 5)
+    {
+        //the order of the values does not matter for the median, so the whole ring can be used as it is
+        *width = _median5(h[0], h[1], h[2], h[3], h[4]);
+    } else if(filter->mode == RCR_FILTER_MEDIAN3 && filter->count >= 3)
+    {
+        uint8_t i = filter->newest;
+        uint8_t j = (i == 0) ? (RCR_FILTER_HISTORY - 1) : (i - 1);
+        uint8_t k = (j == 0) ? (RCR_FILTER_HISTORY - 1) : (j - 1);
+        *width = _median3(h[i], h[j], h[k]);
+    }
+    return true;
+}
+#endif
+
+//Marks the slot as updated and calls the frame callback once all slots of the frame were updated
+static inline void _collectFrame(uint8_t slot)
+{
+    uint32_t updatedMask = _RCReaderUpdatedMask | ((uint32_t)1 << slot);
+    if((updatedMask & _RCReaderFrameMask) == _RCReaderFrameMask)
+    {
+        updatedMask = 0;
+        _RCReaderFrameCallback();
+    }
+    _RCReaderUpdatedMask = updatedMask;
+}
+
+void _calculateRCReaderCurrentValue(_ISR_Mappings currentISR, uint8_t pinStates, RCRTimestamp now)
+{
+    //only the pins that toggled since the last interrupt of this port need to be processed
+    uint8_t changedPins = pinStates ^ _PortLastState[currentISR];
+    _PortLastState[currentISR] = pinStates;
+
+    //loop through the readers of this port only
+    bool updated = false;
+    const _PortDispatchEntry* entry = _PortDispatchTable[currentISR];
+    for(uint8_t i = _PortDispatchCount[currentISR]; i > 0; i--, entry++)
+    {
+        if((changedPins & entry->bitmask) == 0) //this pin did not change, so there is nothing to do
+        {
+            continue;
+        }
+        updated = true;
+        _RCReaderObject* currentReader = &_RCReaderPool[entry->slot];
+
+        bool currentPinState = LOW;
+        if((pinStates & entry->bitmask) != 0) // checking for not 0 because that saves a shifting operation
+        {
+            currentPinState = HIGH;
+        }
+#ifdef RCREADER_ENABLE_STATS
+        _RCReaderStats* stats = &currentReader->stats;
+        stats->edgeCount++;
+        if(currentPinState == currentReader->lastState)
+        {
+            //the pin changed, but not from the level the reader saw last, so edges in between got lost
+            stats->impossibleTransitions++;
+        } else if(currentPinState == HIGH)
+        {
+            uint32_t period = _RCReaderTicksToMicros(now - currentReader->lastTimestamp);
+            stats->framePeriod = (period < 0xFFFF) ? period : 0xFFFF;
+        }
+#endif
+        if(currentReader->ppm != NULL) //PPM readers only need the rising edges
+        {
+            if(currentPinState == HIGH)
+            {
+                _decodePPMEdge(currentReader, now);
+            }
+        } else if(currentPinState == HIGH && currentReader->lastState == LOW) //Start measurement when the pin changes from LOW to HIGH
+        {
+            currentReader->lastTimestamp = now;
+            _resetAge(currentReader);
+        } else if(currentPinState == LOW && currentReader->lastState == HIGH) //Stop measurement and calculate result when pin changes from HIGH to LOW
+        {
+            //unsigned arithmetic gives the right result even if the timestamp overflowed in between
+            uint16_t width = _RCReaderTicksToMicros(now - currentReader->lastTimestamp);
+#ifdef RCREADER_ENABLE_STATS
+            if(width < stats->minimumWidth || stats->minimumWidth == 0)
+            {
+                stats->minimumWidth = width;
+            }
+            if(width > stats->maximumWidth)
+            {
+                stats->maximumWidth = width;
+            }
+#endif
+#ifdef RCREADER_ENABLE_FILTERS
+            if(_filterPulse(&currentReader->filter, &width))
+#endif
+            {
+                currentReader->currentValue = width;
+                currentReader->updateCount++;
+                _recoverFailsafe(&currentReader->failsafe);
+#if RCREADER_OUTPUT_TIMER != 0
+                if(_OutputSlotMask[entry->slot] != 0)
+                {
+                    _updateOutputs(_OutputSlotMask[entry->slot]);
+                }
+#endif
+                if(_RCReaderFrameCallback != NULL)
+                {
+                    _collectFrame(entry->slot);
+                }
+            }
+        }
+        currentReader->lastState = currentPinState; // assinging the last state at every pin change in case the state machine gets messed up.
+    }
+    if(updated)
+    {
+        _RCReaderSequence++; //signal the readers in the main loop that their copies may be inconsistent
+    }
+#ifdef RCREADER_ENABLE_STATS
+    else
+    {
+        _PortStatsTable[currentISR].missedEdges++;
+        //The pin toggled twice before the ISR could read it, so it is back at the level the reader saw last.
+        //The XOR filter above can not tell which pin it was, but with a single reader on the port it can only be that one.
+        if(_PortDispatchCount[currentISR] == 1)
+        {
+            _RCReaderPool[_PortDispatchTable[currentISR][0].slot].stats.impossibleTransitions++;
+        }
+    }
+#endif
+}
+
+#ifdef RCREADER_ENABLE_TRACE
+static inline void _appendTraceRecord(uint16_t delta, uint8_t port, uint8_t pinStates)
+{
+    _TraceRecord* record = &_TraceBuffer[_TraceHead];
+    record->delta = delta;
+    record->port = port;
+    record->pinStates = pinStates;
+    _TraceHead = (_TraceHead + 1 < RCREADER_TRACE_SIZE) ? (_TraceHead + 1) : 0;
+    if(_TraceLength < RCREADER_TRACE_SIZE)
+    {
+        _TraceLength++;
+    } else
+    {
+        _TraceWrapped = true;
+    }
+}
+
+//Records one pin change in the trace buffer if the recording is running
+static inline void _traceEdge(_ISR_Mappings port, uint8_t pinStates, RCRTimestamp now)
+{
+    if(!_TraceActive)
+    {
+        return;
+    }
+    uint32_t delta = now - _TraceLastTime;
+    //a delta that does not fit into 16 bits needs an additional pause record
+    uint8_t neededRecords = (delta > 0xFFFF) ? 2 : 1;
+    if(!_TraceContinuous && _TraceLength + neededRecords > RCREADER_TRACE_SIZE)
+    {
+        if(_TraceDropped != 0xFFFF)
+        {
+            _TraceDropped++;
+        }
+        return;
+    }
+    _TraceLastTime = now;
+    if(neededRecords == 2)
+    {
+        _appendTraceRecord(delta >> 16, RCR_TRACE_PAUSE, 0);
+    }
+    _appendTraceRecord(delta, port, pinStates);
+}
+#endif
+
+//Handles a pin change interrupt: decodes it right away or only queues it for RCReader::poll in deferred mode
+static inline void _processPinChange(_ISR_Mappings port, uint8_t pinStates)
+{
+#ifdef RCREADER_ENABLE_STATS
+    _RCRStatsTicks start = _RCReaderStatsCounter();
+#endif
+    RCRTimestamp now = _RCReaderTimestamp();
+#ifdef RCREADER_ENABLE_TRACE
+    _traceEdge(port, pinStates, now);
+#endif
+#ifdef RCREADER_DEFERRED_DECODE
+    uint16_t time = now;
+    uint8_t nextHead = (_EdgeQueueHead + 1) & (RCREADER_EDGE_QUEUE_SIZE - 1);
+    if(nextHead == _EdgeQueueTail) //queue is full, drop the pin change and remember that there is a gap
+    {
+        _EdgeQueueGap = true;
+    } else
+    {
+        volatile _EdgeRecord* record = &_EdgeQueue[_EdgeQueueHead];
+        record->time = time;
+        record->port = _EdgeQueueGap ? (port | RCR_EDGE_GAP) : port;
+        record->pinStates = pinStates;
+        _EdgeQueueGap = false;
+        _EdgeQueueHead = nextHead; //publish the record only after it was completely written
+    }
+#else
+    _calculateRCReaderCurrentValue(port, pinStates, now);
+#endif
+#ifdef RCREADER_ENABLE_STATS
+    //unsigned arithmetic in the width of the counter handles its overflow
+    _RCRStatsTicks duration = _RCReaderStatsCounter() - start;
+    _PortStats* stats = &_PortStatsTable[port];
+    stats->isrCount++;
+    stats->isrTicks += duration;
+    if(duration > stats->maxIsrTicks)
+    {
+        stats->maxIsrTicks = duration;
+    }
+#endif
+}
+
+#ifdef RCREADER_DEFERRED_DECODE
+//Pin changes were lost, so every measurement that is currently running can be wrong and the port states can not be trusted anymore.
+//Start over with the next rising edge after the state of the port is known again.
+static void _discardRunningMeasurements()
+{
+    _PortResyncMask = (1 << NUM_OF_PCINT_ISRS) - 1;
+    for(uint8_t i = 0; i < TOTAL_NUM_OF_PC_INTERRUPTS; i++)
+    {
+        if(_RCReaderPool[i].refCount != 0)
+        {
+            _RCReaderPool[i].lastState = LOW;
+            if(_RCReaderPool[i].ppm != NULL)
+            {
+                _RCReaderPool[i].ppm->currentChannel = RCR_PPM_NOT_SYNCED;
+            }
+        }
+    }
+}
+#endif
+
+RCRStatus RCReader::poll()
+{
+    RCRStatus status = RCR_OK;
+#ifdef RCREADER_DEFERRED_DECODE
+    //only decode the records that were queued before the current time was taken, so no record is newer than now
+    uint8_t head = _EdgeQueueHead;
+    RCRTimestamp now = _RCReaderTimestamp();
+    while(_EdgeQueueTail != head)
+    {
+        volatile _EdgeRecord* record = &_EdgeQueue[_EdgeQueueTail];
+        if((record->port & RCR_EDGE_GAP) != 0)
+        {
+            _discardRunningMeasurements();
+            status = RCR_QueueOverflow;
+        }
+        uint8_t port = record->port & ~RCR_EDGE_GAP;
+        if((_PortResyncMask & (1 << port)) != 0)
+        {
+            //first record of the port after a gap: the pins that toggled can not be told apart from the ones that toggled in the gap
+            _PortLastState[port] = record->pinStates;
+            _PortResyncMask &= ~(1 << port);
+        } else
+        {
+            //restore the full timestamp, this works as long as the record is not older than one overflow of the 16 bit value
+            //(65ms with micros(), 32ms with a hardware timer)
+            RCRTimestamp time = now - (uint16_t)((uint16_t)now - record->time);
+            _calculateRCReaderCurrentValue((_ISR_Mappings)port, record->pinStates, time);
+        }
+        _EdgeQueueTail = (_EdgeQueueTail + 1) & (RCREADER_EDGE_QUEUE_SIZE - 1); //hand the slot back to the ISRs
+    }
+    if(_EdgeQueueGap)
+    {
+        //pin changes were lost after the last queued one. If all records are decoded the gap is handled right here,
+        //otherwise it is handled by the first record that is queued after it. Either way it is only reported once.
+        uint8_t oldSREG = SREG;
+        noInterrupts();
+        if(_EdgeQueueGap && _EdgeQueueTail == _EdgeQueueHead)
+        {
+            _EdgeQueueGap = false;
+            _discardRunningMeasurements();
+            status = RCR_QueueOverflow;
+        }
+        SREG = oldSREG;
+    }
+#endif
+    return status;
+}
+
+#ifdef RCREADER_ENABLE_TRACE
+void RCReader::startTrace(bool continuous)
+{
+    uint8_t oldSREG = SREG;
+    noInterrupts();
+    _TraceHead = 0;
+    _TraceLength = 0;
+    _TraceDropped = 0;
+    _TraceWrapped = false;
+    _TraceContinuous = continuous;
+    _TraceLastTime = _RCReaderTimestamp();
+    for(uint8_t port = 0; port < NUM_OF_PCINT_ISRS; port++)
+    {
+        _TraceStartStates[port] = _readPortState((_ISR_Mappings)port);
+    }
+    _TraceActive = true;
+    SREG = oldSREG;
+}
+
+void RCReader::stopTrace()
+{
+    _TraceActive = false; //single byte, so no protection needed
+}
+
+uint16_t RCReader::getTraceLength()
+{
+    uint8_t oldSREG = SREG;
+    noInterrupts();
+    uint16_t length = _TraceLength;
+    SREG = oldSREG;
+    return length;
+}
+
+//multi byte values of the trace are sent in little endian byte order
+static void _writeTraceValue(Print& output, uint16_t value)
+{
+    output.write((uint8_t)value);
+    output.write((uint8_t)(value >> 8));
+}
+
+void RCReader::dumpTrace(Print& output)
+{
+    //once the recording is stopped the ISRs do not touch the buffer anymore, so it can be sent with interrupts enabled
+    stopTrace();
+    const uint8_t magic[] = {'R', 'C', 'R', 'T'};
+    output.write(magic, sizeof(magic));
+    output.write((uint8_t)RCR_TRACE_VERSION);
+    output.write((uint8_t)RCR_TICKS_PER_MICROSECOND);
+    output.write((uint8_t)((_TraceWrapped ? RCR_TRACE_WRAPPED : 0) | (_TraceContinuous ? RCR_TRACE_CONTINUOUS : 0)));
+    output.write((uint8_t)0);
+    _writeTraceValue(output, _TraceLength);
+    _writeTraceValue(output, _TraceDropped);
+    output.write(_TraceStartStates, NUM_OF_PCINT_ISRS);
+    output.write((uint8_t)0);
+    //oldest record first
+    uint16_t index = (_TraceHead + RCREADER_TRACE_SIZE - _TraceLength) % RCREADER_TRACE_SIZE;
+    for(uint16_t i = 0; i < _TraceLength; i++)
+    {
+        _writeTraceValue(output, _TraceBuffer[index].delta);
+        output.write(_TraceBuffer[index].port);
+        output.write(_TraceBuffer[index].pinStates);
+        index = (index + 1 < RCREADER_TRACE_SIZE) ? (index + 1) : 0;
+    }
+}
+#endif
+
+void _RCReaderRuntimeISR(uint8_t port)
+{
+    _processPinChange((_ISR_Mappings)port, _readPortState((_ISR_Mappings)port));
+}
+
+//Ages all measurements every 1.024ms and switches them into the failsafe if they are too old.
+//This keeps the reads free of any time calculation and detects a signal loss even if the main loop is stalled.
+ISR(TIMER0_COMPA_vect)
+{
+#if RCREADER_OUTPUT_TIMER != 0
+    if(_OutputComBits != 0)
+    {
+        _checkOutputTimer();
+    }
+#endif
+    for(uint8_t port = 0; port < NUM_OF_PCINT_ISRS; port++)
+    {
+        const _PortDispatchEntry* entry = _PortDispatchTable[port];
+        for(uint8_t i = _PortDispatchCount[port]; i > 0; i--, entry++)
+        {
+            _RCReaderObject* reader = &_RCReaderPool[entry->slot];
+            if(reader->age != 0xFFFF)
+            {
+                reader->age++;
+            }
+            if(reader->age > reader->failsafe.ticks && reader->failsafe.ticks != 0)
+            {
+#if RCREADER_OUTPUT_TIMER != 0
+                if(!reader->failsafe.active && _OutputSlotMask[entry->slot] != 0)
+                {
+                    reader->failsafe.active = true;
+                    _updateOutputs(_OutputSlotMask[entry->slot]); //move the outputs to the failsafe value right away
+                }
+#endif
+                reader->failsafe.active = true;
+                reader->failsafe.recoveryCount = 0;
+            }
+        }
+    }
+    if(_PortDispatchCount[PCINT0_ISR] != 0 || _PortDispatchCount[PCINT1_ISR] != 0 || _PortDispatchCount[PCINT2_ISR] != 0)
+    {
+        _RCReaderSequence++; //the ages changed, copies that include them have to be repeated
+    }
+}
+
+//The ISRs are weak so a RCReaderSet can replace them with versions generated for its pin configuration
+ISR(PCINT2_vect, __attribute__((weak)))
+{
+    #ifdef DISABLE_INTERRUPTS_DURING_CALCULAION
+        noInterrupts();
+    #endif
+    //reading in the state of the whole PORT at once to make sure the values are not changing while the calculation is happening:
+    _processPinChange(PCINT2_ISR, PINK);
+    #ifdef DISABLE_INTERRUPTS_DURING_CALCULAION
+        interrupts();
+    #endif
+}
+
+ISR(PCINT1_vect, __attribute__((weak)))
+{
+    #ifdef DISABLE_INTERRUPTS_DURING_CALCULAION
+        noInterrupts();
+    #endif
+    //unfortiunatly this is a special case bacause the pin 0 (PE0) is not on the same port as all other pins (PJ0-6) of this interrupt
+    //PE0 is read directly from its port register instead of using digitalRead to keep the ISR short
+    _processPinChange(PCINT1_ISR, _readPortState(PCINT1_ISR));
+    #ifdef DISABLE_INTERRUPTS_DURING_CALCULAION
+        interrupts();
+    #endif
+}
+
+ISR(PCINT0_vect, __attribute__((weak)))
+{
+    #ifdef DISABLE_INTERRUPTS_DURING_CALCULAION
+        noInterrupts();
+    #endif
+    _processPinChange(PCINT0_ISR, PINB);
+    #ifdef DISABLE_INTERRUPTS_DURING_CALCULAION
+        interrupts();
+    #endif
+}
+
+#if RCREADER_OUTPUT_TIMER != 0
+RCReaderOutput::RCReaderOutput(RCROutputChannel channel, uint16_t minimum, uint16_t maximum, uint16_t center)
+{
+    _channel = RCR_INVALID_SLOT;
+    if(channel >= RCR_NUM_OF_OUTPUTS || (_OutputComBits & _OutputComMasks[channel]) != 0)
+    {
+        return; //channel is already used by another RCReaderOutput
+    }
+    for(uint8_t i = 0; i < TOTAL_NUM_OF_PC_INTERRUPTS; i++)
+    {
+        if(_RCReaderPool[i].refCount != 0 && _RCReaderPool[i].attatchedPin == _OutputPins[channel])
+        {
+            return; //the pin is an input of a RCReader
+        }
+    }
+    _channel = channel;
+    _RCReaderOutputObject* object = &_OutputTable[channel];
+    for(uint8_t i = 0; i < RCREADER_OUTPUT_INPUTS; i++)
+    {
+        object->inputs[i] = RCR_INVALID_SLOT;
+    }
+    object->minimum = minimum;
+    object->maximum = maximum;
+    object->center = center;
+    _writeOutput(channel, center);
+    pinMode(_OutputPins[channel], OUTPUT);
+
+    uint8_t oldSREG = SREG;
+    noInterrupts();
+    _OutputComBits |= _OutputComMasks[channel];
+    _checkOutputTimer();
+    _updateTickInterrupt();
+    SREG = oldSREG;
+}
+
+RCReaderOutput::~RCReaderOutput()
+{
+    if(_channel == RCR_INVALID_SLOT)
+    {
+        return;
+    }
+    uint8_t oldSREG = SREG;
+    noInterrupts();
+    _OutputComBits &= ~_OutputComMasks[_channel];
+    _RCR_OUTPUT_REG(TCCR, A) &= ~_OutputComMasks[_channel]; //gives the pin back to digitalWrite
+    for(uint8_t slot = 0; slot < TOTAL_NUM_OF_PC_INTERRUPTS; slot++)
+    {
+        _OutputSlotMask[slot] &= ~(1 << _channel);
+    }
+    _updateTickInterrupt();
+    SREG = oldSREG;
+    digitalWrite(_OutputPins[_channel], LOW);
+}
+
+RCRStatus RCReaderOutput::addInput(RCReader& reader, int16_t weight)
+{
+    if(_channel == RCR_INVALID_SLOT || reader._RCReaderIndexNum == RCR_INVALID_SLOT)
+    {
+        return RCR_InitFailed;
+    }
+    _RCReaderOutputObject* object = &_OutputTable[_channel];
+    for(uint8_t i = 0; i < RCREADER_OUTPUT_INPUTS; i++)
+    {
+        if(object->inputs[i] == RCR_INVALID_SLOT)
+        {
+            uint8_t oldSREG = SREG;
+            noInterrupts();
+            object->inputs[i] = reader._RCReaderIndexNum;
+            object->weights[i] = weight;
+            _OutputSlotMask[reader._RCReaderIndexNum] |= (1 << _channel);
+            _updateOutputs(1 << _channel);
+            SREG = oldSREG;
+            return RCR_OK;
+        }
+    }
+    return RCR_InitFailed; //no input left
+}
+
+void RCReaderOutput::clearInputs()
+{
+    if(_channel == RCR_INVALID_SLOT)
+    {
+        return;
+    }
+    uint8_t oldSREG = SREG;
+    noInterrupts();
+    for(uint8_t i = 0; i < RCREADER_OUTPUT_INPUTS; i++)
+    {
+        _OutputTable[_channel].inputs[i] = RCR_INVALID_SLOT;
+    }
+    for(uint8_t slot = 0; slot < TOTAL_NUM_OF_PC_INTERRUPTS; slot++)
+    {
+        _OutputSlotMask[slot] &= ~(1 << _channel);
+    }
+    SREG = oldSREG;
+}
+
+void RCReaderOutput::writeMicroseconds(uint16_t value)
+{
+    if(_channel != RCR_INVALID_SLOT)
+    {
+        _writeOutput(_channel, value);
+    }
+}
+
+uint16_t RCReaderOutput::readMicroseconds()
+{
+    if(_channel == RCR_INVALID_SLOT)
+    {
+        return 0;
+    }
+    uint8_t oldSREG = SREG;
+    noInterrupts();
+    uint16_t value = *_OutputRegisters[_channel];
+    SREG = oldSREG;
+    return value / 2;
+}
+#endif
@@ -8,6 +8,8 @@
 #include <avr/interrupt.h>
 #include <Arduino.h>
 
+//The numeric settings below can also be overridden with compiler flags (e.g. -DRCREADER_TIMESTAMP_TIMER=5)
+
 //maximum number of interrupts in this case is 18 beacuse the ATMega2560 has 23 Pin Change Interrupts, but 5 of them are not connected to the arduino board
 #define TOTAL_NUM_OF_PC_INTERRUPTS 18
 
@@ -15,6 +17,70 @@
 //Comment this out to leave the interrupts enabled. (Can help with problems related to bus communication which relies heavily on interrupts)
 #define DISABLE_INTERRUPTS_DURING_CALCULAION
 
+//Source of the timestamps that are taken once at the start of every pin change interrupt:
+//0:            micros() is used. Resolution is 4us. (default)
+//1, 3, 4, 5:   The 16 bit hardware timer with this number is used as free running counter with a resolution of 0.5us.
+//              Reading it takes far less cycles than micros(), but the timer can not be used for anything else (PWM outputs, Servo library, ...).
+#ifndef RCREADER_TIMESTAMP_TIMER
+    #define RCREADER_TIMESTAMP_TIMER 0
+#endif
+
+//16 bit hardware timer that generates the servo signals of the RCReaderOutput class:
+//0:            No outputs. (default)
+//1, 3, 4, 5:   The compare outputs A, B and C of this timer are used (timer 1: pins 11, 12, 13   timer 3: pins 5, 2, 3
+//              timer 4: pins 6, 7, 8   timer 5: pins 46, 45, 44). The timer can not be used for anything else.
+#ifndef RCREADER_OUTPUT_TIMER
+    #define RCREADER_OUTPUT_TIMER 0
+#endif
+//Maximum number of RCReader inputs that can be mixed into one output
+#ifndef RCREADER_OUTPUT_INPUTS
+    #define RCREADER_OUTPUT_INPUTS 2
+#endif
+
+//Both features reconfigure their timer completely, so they can not share it (e.g. both set to timer 1)
+#if RCREADER_OUTPUT_TIMER != 0 && RCREADER_OUTPUT_TIMER == RCREADER_TIMESTAMP_TIMER
+    #error RCREADER_OUTPUT_TIMER and RCREADER_TIMESTAMP_TIMER have to be different timers
+#endif
+
+//Uncomment this to enable the optional glitch filters of the RCReader (see RCReader::setFilter).
+//Costs 16 bytes of SRAM per reader slot and a few cycles per pulse of readers that have a filter configured.
+//#define RCREADER_ENABLE_FILTERS
+
+//Uncomment this to enable the calibrated output of the RCReader (see RCReader::setCalibration and RCReader::getNormalized).
+//Costs 46 bytes of SRAM per RCReader instance.
+//#define RCREADER_ENABLE_CALIBRATION
+
+//Maximum number of channels a RCReaderPPM can decode from one PPM sum signal
+#ifndef RCREADER_PPM_MAX_CHANNELS
+    #define RCREADER_PPM_MAX_CHANNELS 12
+#endif
+//A time between two rising edges of a PPM signal that is longer than this (in microseconds) is detected as sync gap between two frames
+#ifndef RCREADER_PPM_SYNC_GAP
+    #define RCREADER_PPM_SYNC_GAP 3000
+#endif
+
+//Uncomment this to only queue the pin changes in the ISRs and decode them later in the main loop by calling RCReader::poll().
+//This keeps the ISRs short and constant in time (helps with bus communication), but poll() has to be called at least every 30ms.
+//#define RCREADER_DEFERRED_DECODE
+
+//Number of pin changes that can be queued between two calls of RCReader::poll(). Has to be a power of 2 and not larger than 128.
+#ifndef RCREADER_EDGE_QUEUE_SIZE
+    #define RCREADER_EDGE_QUEUE_SIZE 32
+#endif
+
+//Uncomment this to record every pin change into a RAM buffer that can be sent to a PC with RCReader::dumpTrace.
+//The recorded signal can be decoded again on the PC with the replay tool in extras/trace.
+//#define RCREADER_ENABLE_TRACE
+
+//Uncomment this to count ISR calls and ISR time per port and edges, pulse widths and errors per reader (see RCReader::getStats).
+//Costs 12 bytes of SRAM per reader slot and a few cycles per pin change.
+//#define RCREADER_ENABLE_STATS
+
+//Number of pin changes the trace buffer can hold. Every record takes 4 bytes of SRAM.
+#ifndef RCREADER_TRACE_SIZE
+    #define RCREADER_TRACE_SIZE 256
+#endif
+
 
 /*Pin Change Interrupt(PCI) pin mappings:
 Available pins for PCI on the ATMega2560:
@@ -54,7 +120,153 @@ enum RCReaderPin {RCR_PIN_53 = 53, RCR_PIN_52 = 52, RCR_PIN_51 = 51, RCR_PIN_50
                   RCR_PIN_14 = 14, RCR_PIN_15 = 15, //PORT J
                   RCR_PIN_A8 = A8, RCR_PIN_A9 = A9, RCR_PIN_A10 = A10, RCR_PIN_A11 = A11, RCR_PIN_A12 = A12, RCR_PIN_A13 = A13, RCR_PIN_A14 = A14, RCR_PIN_A15 = A15};   //PORT K
 
-enum RCRStatus {RCR_OK, RCR_InvalidValue, RCR_Timeout, RCR_InitFailed};
+enum RCRStatus {RCR_OK, RCR_InvalidValue, RCR_Timeout, RCR_InitFailed, RCR_QueueOverflow};
+
+enum RCRFilterMode {RCR_FILTER_NONE, RCR_FILTER_MEDIAN3, RCR_FILTER_MEDIAN5};
+
+#if RCREADER_OUTPUT_TIMER != 0
+//Compare outputs of RCREADER_OUTPUT_TIMER, see the pins in the description of RCREADER_OUTPUT_TIMER
+enum RCROutputChannel {RCR_OUTPUT_A, RCR_OUTPUT_B, RCR_OUTPUT_C};
+#endif
+
+#ifdef RCREADER_ENABLE_CALIBRATION
+//Number of linear segments the expo curve of the calibration is split into
+#define RCR_CALIBRATION_SEGMENTS 16
+//Value returned by RCReader::getNormalized at the end points
+#define RCR_NORMALIZED_MAXIMUM 1000
+#endif
+
+//Compile time version of the pin to PCINT number translation, so the same table can be used by RCReaderSet
+constexpr uint8_t _RCReaderPinToInterrupt(RCReaderPin pin)
+{
+    return pin == RCR_PIN_53 ? 0 : pin == RCR_PIN_52 ? 1 : pin == RCR_PIN_51 ? 2 : pin == RCR_PIN_50 ? 3 :
+           pin == RCR_PIN_10 ? 4 : pin == RCR_PIN_11 ? 5 : pin == RCR_PIN_12 ? 6 : pin == RCR_PIN_13 ? 7 :
+           pin == RCR_PIN_0 ? 8 : pin == RCR_PIN_15 ? 9 : pin == RCR_PIN_14 ? 10 :
+           pin == RCR_PIN_A8 ? 16 : pin == RCR_PIN_A9 ? 17 : pin == RCR_PIN_A10 ? 18 : pin == RCR_PIN_A11 ? 19 :
+           pin == RCR_PIN_A12 ? 20 : pin == RCR_PIN_A13 ? 21 : pin == RCR_PIN_A14 ? 22 : pin == RCR_PIN_A15 ? 23 : 255;
+}
+
+//PCINT port (0-2) a pin belongs to
+constexpr uint8_t _RCReaderPinToPort(RCReaderPin pin)
+{
+    return _RCReaderPinToInterrupt(pin) / 8;
+}
+
+//Bit of the pin inside the port state the ISRs are working with.
+//PE0 (PCINT8) is not on PORTJ, so it is moved to the unused bit 7 of the PORTJ state.
+constexpr uint8_t _RCReaderPinStateMask(RCReaderPin pin)
+{
+    return _RCReaderPinToPort(pin) != 1 ? (1 << (_RCReaderPinToInterrupt(pin) % 8)) :
+           pin == RCR_PIN_0 ? 0x80 : (1 << (_RCReaderPinToInterrupt(pin) - 9));
+}
+
+//Timestamps are counted in ticks of the configured source. Elapsed times are always calculated with unsigned arithmetic,
+//so the overflow of the counter does not need any special handling.
+typedef uint32_t RCRTimestamp;
+
+//Helpers to build the register names of the configured timers, e.g. _RCR_TIMER_REG(TCCR, B) -> TCCR5B
+#define _RCR_CONCAT3_(a, b, c) a##b##c
+#define _RCR_CONCAT3(a, b, c) _RCR_CONCAT3_(a, b, c)
+
+#if RCREADER_TIMESTAMP_TIMER == 0
+#define RCR_TICKS_PER_MICROSECOND 1
+
+inline RCRTimestamp _RCReaderTimestamp()
+{
+    return micros();
+}
+#else
+#define RCR_TICKS_PER_MICROSECOND 2
+
+#define _RCR_TIMER_REG(prefix, suffix) _RCR_CONCAT3(prefix, RCREADER_TIMESTAMP_TIMER, suffix)
+
+//Upper 16 bits of the timestamp, counted up by the overflow interrupt of the timer
+extern volatile uint16_t _RCReaderTimerOverflows;
+
+//Normal mode with a prescaler of 8: the timer counts from 0 to 0xFFFF with 2MHz
+inline void _RCReaderStartTimestampTimer()
+{
+    _RCR_TIMER_REG(TCCR, A) = 0;
+    _RCR_TIMER_REG(TCCR, B) = (1 << _RCR_TIMER_REG(CS, 1));
+    _RCR_TIMER_REG(TIMSK, ) |= (1 << _RCR_TIMER_REG(TOIE, ));
+}
+
+inline RCRTimestamp _RCReaderTimestamp()
+{
+    uint8_t oldSREG = SREG;
+    noInterrupts();
+    //Arduino's init() reconfigures all timers after the global constructors ran, so the configuration is restored here if needed
+    if(_RCR_TIMER_REG(TCCR, B) != (1 << _RCR_TIMER_REG(CS, 1)))
+    {
+        _RCReaderStartTimestampTimer();
+    }
+    uint16_t count = _RCR_TIMER_REG(TCNT, );
+    uint16_t overflows = _RCReaderTimerOverflows;
+    //an overflow that happened right before the counter was read is not counted yet
+    if((_RCR_TIMER_REG(TIFR, ) & (1 << _RCR_TIMER_REG(TOV, ))) != 0 && count < 0x8000)
+    {
+        overflows++;
+    }
+    SREG = oldSREG;
+    return ((uint32_t)overflows << 16) | count;
+}
+#endif
+
+#if RCREADER_OUTPUT_TIMER != 0
+//Same as _RCR_TIMER_REG for the timer of the outputs, e.g. _RCR_OUTPUT_REG(OCR, A) -> OCR3A
+#define _RCR_OUTPUT_REG(prefix, suffix) _RCR_CONCAT3(prefix, RCREADER_OUTPUT_TIMER, suffix)
+#endif
+
+#ifdef RCREADER_ENABLE_STATS
+//The ISR time is measured with the timer of the timestamps if one is configured, otherwise with Timer0 that is running for micros()
+#if RCREADER_TIMESTAMP_TIMER == 0
+#define RCR_STATS_CYCLES_PER_TICK 64
+typedef uint8_t _RCRStatsTicks;
+
+inline _RCRStatsTicks _RCReaderStatsCounter()
+{
+    return TCNT0;
+}
+#else
+#define RCR_STATS_CYCLES_PER_TICK 8
+typedef uint16_t _RCRStatsTicks;
+
+inline _RCRStatsTicks _RCReaderStatsCounter()
+{
+    return _RCR_TIMER_REG(TCNT, );
+}
+#endif
+
+//Counters of one PCINT port, see RCReader::getPortStats
+struct RCRPortStats
+{
+    uint32_t isrCount;          //number of pin change interrupts
+    uint32_t isrCycles;         //CPU cycles spent in the library code of all these interrupts
+    uint16_t maxIsrCycles;      //longest single interrupt
+    uint16_t missedEdges;       //interrupts in which no pin of a reader changed, the pin toggled twice before its level was read
+};
+
+//Counters of one measured pin, see RCReader::getStats
+struct RCRReaderStats
+{
+    uint32_t edgeCount;             //pin changes of the pin
+    uint16_t minimumWidth;          //shortest pulse in microseconds before any filter, 0 if no pulse was measured
+    uint16_t maximumWidth;          //longest pulse in microseconds before any filter
+    uint16_t jitter;                //maximumWidth - minimumWidth
+    uint16_t framePeriod;           //time between the last two rising edges in microseconds, 0xFFFF if longer
+    uint16_t frameRate;             //frames per second calculated from framePeriod
+    uint16_t impossibleTransitions; //pin changes to the level the pin already had, every one means at least one edge was missed.
+                                    //Also counts the interrupts in which no pin changed if the reader is the only one of its port.
+};
+#endif
+
+inline uint32_t _RCReaderTicksToMicros(RCRTimestamp ticks)
+{
+    return ticks / RCR_TICKS_PER_MICROSECOND;
+}
+
+//Runs the runtime RCReader processing for one PCINT port (0-2). Used by ISRs that are defined outside of the library.
+void _RCReaderRuntimeISR(uint8_t port);
 
 class RCReader
 {
@@ -64,6 +276,8 @@ public:
     * please use the provided pindefines, as only these pins work with this library. All of them are named like RCR_PIN_<ArduinoPinName>.
     * Optionally a timeout value can be set at which a Reader is considered inactive. A value of 0 disables the timeout detection.
     * Also optionally a min and max value that are expected to be measured can be set to validate the measurements.
+    * Multiple RCReader instances can be attached to the same pin. They share one measurement but each one keeps its own
+    * timeout, range and error behavior configuration.
     * 
     * Parameters:
     *   - PinToAttach:              The pin to read in. Posssible choices can be found looking at the RCReaderPin enum.
@@ -92,13 +306,17 @@ public:
     */
     ~RCReader();
 
+    //the slots and channels are released by the destructor, a copy would release them a second time
+    RCReader(const RCReader&) = delete;
+    RCReader& operator=(const RCReader&) = delete;
+
     /*
     * Passes the last calculated high time of the signal in microseconds via reference.
     * If a valid maximum and minimum value are configured it returns the "RCR_InvalidValue" flag in case of an error
     * and holds the last valid value if it was configured to do so using the setValidRange function.
     * If no valid range has been set it will always pass on the measured value and return the "RCR_OK" flag without doing any checks.
     * If a timeout error was detected (if a timeout period was set before) the function will still pass on the last measured value
-    * but it will return the "RCR_timeout" flag.
+    * (or the failsafe value if one was configured with setFailsafe) but it will return the "RCR_timeout" flag.
     * 
     * Parameters:
     *   - Value: This is the variable where the value should be stored in. 
@@ -117,7 +335,8 @@ public:
     * If a valid maximum and minimum value are configured it returns -1 in case of an error
     * But if it was configured to hold the last valid value using the setValidRange function there will be no error indication.
     * If no valid range has been set it will always return the measured value without doing any checks.
-    * If a timeout error was detected (if a timeout period was set before) the function will return -1.
+    * If a timeout error was detected (if a timeout period was set before) the function will return -1,
+    * or the failsafe value if one was configured with setFailsafe.
     * 
     * Returns:
     *   - (-1) in case of an error, if any checks were configured
@@ -156,18 +375,456 @@ public:
     */
     void setTimeout(uint16_t timeoutInMilliseconds);
 
+#ifdef RCREADER_ENABLE_FILTERS
+    /*
+    * Configures the glitch filters that are applied in the ISR to every new pulse, so getMicroseconds returns the filtered value.
+    * The filters work on the measurement of the pin, so they are shared by all RCReader instances attached to the same pin.
+    * Calling this function resets the filter history.
+    * 
+    * Parameters:
+    *   - mode:     RCR_FILTER_NONE disables the median filter.
+    *               RCR_FILTER_MEDIAN3 and RCR_FILTER_MEDIAN5 return the median of the last 3 or 5 pulses.
+    * 
+    *   - maxDelta: Default: 0
+    *               If not 0 a single pulse that differs by more than this from the last accepted pulse is rejected as a spike.
+    *               If the next pulse differs by that much as well it is accepted, so real fast stick movements still get through.
+    */
+    void setFilter(RCRFilterMode mode, uint16_t maxDelta = 0);
+#endif
+
+    /*
+    * Returns true if a new pulse was measured since the value was last read with getMicroseconds or RCReaderGroup::snapshot.
+    * Can be used to skip processing of values that did not change.
+    */
+    bool hasNewValue();
+
+    /*
+    * Configures the failsafe of the pin. The signal is monitored by a timer interrupt every 1.024ms, so a lost signal
+    * is detected even if getMicroseconds is not called or the main loop is stalled.
+    * Once no rising edge was detected for the given time the pin is in failsafe: getMicroseconds returns the "RCR_Timeout" flag
+    * and passes the failsafe value. The failsafe is only left after the given number of complete pulses has been received again,
+    * so a signal that is just flickering does not toggle the outputs. Like the filters the failsafe is shared by
+    * all RCReader instances attached to the same pin.
+    * 
+    * Parameters:
+    *   - timeoutInMilliseconds: Time without a rising edge after which the failsafe is activated. 0 disables the failsafe.
+    * 
+    *   - failsafeValue:         Default: 0
+    *                            Value that is passed by getMicroseconds during a timeout, also by the version that returns
+    *                            the value directly instead of -1. If set to 0 the last measured value is passed.
+    * 
+    *   - recoveryPulses:        Default: 3
+    *                            Number of complete pulses that have to be received to leave the failsafe again.
+    */
+    void setFailsafe(uint16_t timeoutInMilliseconds, uint16_t failsafeValue = 0, uint8_t recoveryPulses = 3);
+
+    /*
+    * Returns true while the pin is in failsafe, see setFailsafe.
+    */
+    bool isFailsafe();
+
+#ifdef RCREADER_ENABLE_CALIBRATION
+    /*
+    * Configures the conversion of the pulse width into the normalized value that is returned by getNormalized.
+    * The curve is calculated once by this function, the conversion itself only uses integer math and a small lookup table.
+    * The default calibration is 1000, 1500 and 2000us without deadband and expo.
+    * The call is ignored if the center is not between the minimum and the maximum.
+    * 
+    * Parameters:
+    *   - minimum, center, maximum: Pulse widths in microseconds that are mapped to -1000, 0 and 1000.
+    *                               Values outside of the minimum and maximum are limited to -1000 and 1000.
+    * 
+    *   - deadband:                 Default: 0
+    *                               Pulse widths that differ from the center by this or less are returned as 0.
+    * 
+    *   - expo:                     Default: 0
+    *                               0 to 100 percent. Blends the linear curve with a cubic one, so the stick is less sensitive around the center.
+    */
+    void setCalibration(uint16_t minimum, uint16_t center, uint16_t maximum, uint16_t deadband = 0, uint8_t expo = 0);
+
+    /*
+    * Passes the value of getMicroseconds converted with the calibration to a value between -1000 and 1000 via reference.
+    * The conversion is only calculated again if the pulse width changed since the last call.
+    * 
+    * Parameters:
+    *   - Value: This is the variable where the value should be stored in.
+    * 
+    * Returns:
+    *   - The same status as getMicroseconds. If it is RCR_InitFailed 0 is passed.
+    *   - RCR_InvalidValue and 0 until the first pulse was measured (RCR_Timeout if a timeout is configured and passed).
+    */
+    RCRStatus getNormalized(int16_t* Value);
+#endif
+
+    /*
+    * Decodes all pin changes that were queued by the ISRs since the last call and updates the values of all RCReader instances.
+    * Only needed if RCREADER_DEFERRED_DECODE is enabled, otherwise it returns RCR_OK without doing anything.
+    * It has to be called regularly from the main loop, the queued timestamps are only valid for about 30ms.
+    * 
+    * Returns:
+    *   - RCR_OK if all pin changes were decoded.
+    *   - RCR_QueueOverflow if the ISRs had to drop pin changes because the queue was full. The measurements affected by
+    *     the lost pin changes are discarded, all readers continue with the next complete pulse.
+    *     Every overflow is only reported once, by the call that decodes the pin changes around it.
+    *     getMicroseconds does not report it.
+    */
+    static RCRStatus poll();
+
+#ifdef RCREADER_ENABLE_STATS
+    /*
+    * Copies the counters of the measurement of this reader. They are shared by all RCReader instances attached to the same pin.
+    * PPM readers only count edges, impossible transitions and the frame period.
+    * 
+    * Parameters:
+    *   - stats:    Receives the counters.
+    *   - reset:    Default: false
+    *               If true all counters are cleared after copying them, e.g. to get the numbers per second.
+    * 
+    * Returns:
+    *   - RCR_InitFailed if the initialization of the reader failed, RCR_OK otherwise.
+    */
+    RCRStatus getStats(RCRReaderStats* stats, bool reset = false);
+
+    /*
+    * Copies the counters of a pin change interrupt. The time is measured from the start to the end of the library code in the ISR,
+    * with a resolution of 64 cycles (8 cycles if RCREADER_TIMESTAMP_TIMER is set). In deferred mode it does not include the decoding in poll().
+    * 
+    * Parameters:
+    *   - port:     PCINT port 0-2 (PCINT0: pins 10-13 and 50-53, PCINT1: pins 0, 14 and 15, PCINT2: pins A8-A15)
+    *   - stats:    Receives the counters.
+    *   - reset:    Default: false
+    *               If true all counters are cleared after copying them.
+    * 
+    * Returns:
+    *   - RCR_InitFailed if the port number is invalid, RCR_OK otherwise.
+    */
+    static RCRStatus getPortStats(uint8_t port, RCRPortStats* stats, bool reset = false);
+#endif
+
+#ifdef RCREADER_ENABLE_TRACE
+    /*
+    * Clears the trace buffer and starts recording the pin changes of all ports that have a RCReader attached.
+    * 
+    * Parameters:
+    *   - continuous:   Default: false
+    *                   If false the recording stops when the buffer is full, so it contains the first RCREADER_TRACE_SIZE pin changes.
+    *                   If true the oldest records are overwritten, so it always contains the latest pin changes.
+    *                   Can be used to capture what happened right before an error was detected.
+    */
+    static void startTrace(bool continuous = false);
+
+    /*
+    * Stops recording pin changes. The recorded trace is kept until startTrace is called again.
+    */
+    static void stopTrace();
+
+    /*
+    * Returns the number of records in the trace buffer.
+    */
+    static uint16_t getTraceLength();
+
+    /*
+    * Stops the recording and writes the trace to the output (e.g. Serial) in the binary format described in extras/trace/README.md.
+    * 
+    * Parameters:
+    *   - output:   Where the trace is written to.
+    */
+    static void dumpTrace(Print& output);
+#endif
+
 private:
     //Internal configuration variables:
     uint16_t _validMinimum;
     uint16_t _validMaximum;
     uint16_t _lastValidValue;
-    uint16_t _timeout;
+    uint16_t _timeoutTicks;   //timeout in ticks of the failsafe timer interrupt
     bool _holdLastValidValue;
     //internal record to know at which array location the object is located at
     uint8_t _RCReaderIndexNum;
+    //update counter of the _RCReaderObject at the time of the last read, used by hasNewValue
+    uint8_t _lastUpdateCount;
+
+#ifdef RCREADER_ENABLE_CALIBRATION
+    uint16_t _calibrationCenter;
+    uint16_t _calibrationDeadband;
+    uint16_t _calibrationScale[2];  //maps the pulse widths below and above the center to 0-1024, 8 fractional bits
+    uint16_t _calibrationCurve[RCR_CALIBRATION_SEGMENTS + 1];   //0-1000 for the positions 0, 64, ..., 1024
+    uint16_t _normalizedInput;      //pulse width _normalizedValue was calculated for
+    int16_t _normalizedValue;
+#endif
+
+    //timeout and range checks on an already copied value
+    RCRStatus _checkValue(uint16_t currentValue, uint16_t age, bool failsafeActive, uint16_t* Value);
+#ifdef RCREADER_ENABLE_CALIBRATION
+    int16_t _normalize(uint16_t microseconds);
+#endif
+
+    friend class RCReaderGroup;
+#if RCREADER_OUTPUT_TIMER != 0
+    friend class RCReaderOutput;
+#endif
+};
+
+//Decoding state of a PPM sum signal. Written by the ISR, so it is stored in the RCReaderPPM object and referenced by its _RCReaderObject.
+struct _RCReaderPPMData
+{
+    volatile uint16_t values[RCREADER_PPM_MAX_CHANNELS];
+    volatile uint8_t currentChannel;
+    volatile uint8_t channelCount;
+    volatile uint16_t frameCounter;
+};
+
+class RCReaderPPM
+{
+public:
+    /*
+    * Decodes a PPM (CPPM) sum signal that contains all channels of a receiver on one pin.
+    * The same pins as for the RCReader can be used. The channels are numbered in the order they appear in the PPM frame, starting at 0.
+    * The timeout, range checks and error behavior are the same as for the RCReader class and apply to every channel.
+    * 
+    * Parameters:
+    *   - See the RCReader constructor.
+    */
+    RCReaderPPM(RCReaderPin PinToAttach, uint16_t timeoutInMilliseconds = 0, uint16_t validMinimumValue = 0, uint16_t validMaximumValue = 0, bool holdLastValueOnFailure = false);
+
+    /*
+    * Disables this RCReaderPPM instance from the processing
+    */
+    ~RCReaderPPM();
+
+    //the slots and channels are released by the destructor, a copy would release them a second time
+    RCReaderPPM(const RCReaderPPM&) = delete;
+    RCReaderPPM& operator=(const RCReaderPPM&) = delete;
+
+    /*
+    * Same as RCReader::getMicroseconds(uint16_t* Value) for one channel of the PPM signal.
+    * If the channel was not part of the last complete frame RCR_InvalidValue is returned.
+    * If the channel number is larger than RCREADER_PPM_MAX_CHANNELS or the initialization failed RCR_InitFailed is returned.
+    */
+    RCRStatus getMicroseconds(uint8_t channel, uint16_t* Value);
+
+    /*
+    * Same as RCReader::getMicroseconds() for one channel of the PPM signal.
+    */
+    int getMicroseconds(uint8_t channel);
+
+    /*
+    * Returns the number of channels that were contained in the last complete frame, 0 if no frame was received yet.
+    */
+    uint8_t getChannelCount();
+
+    /*
+    * Returns the number of complete frames that were received. Can be used to check if new values are available. 
+    * Overflows back to 0 after 65535.
+    */
+    uint16_t getFrameCounter();
+
+    /*
+    * Same as RCReader::setValidRange, the range is used for all channels.
+    */
+    void setValidRange(uint16_t validMinimumValue, uint16_t validMaximumValue, bool holdLastValueOnFailure = false);
+
+    /*
+    * Same as RCReader::setTimeout. A timeout is detected if no edge was seen on the pin for the given time.
+    */
+    void setTimeout(uint16_t timeoutInMilliseconds);
+
+private:
+    uint16_t _validMinimum;
+    uint16_t _validMaximum;
+    uint16_t _lastValidValues[RCREADER_PPM_MAX_CHANNELS];
+    uint16_t _timeoutTicks;   //timeout in ticks of the failsafe timer interrupt
+    bool _holdLastValidValue;
+    uint8_t _RCReaderIndexNum;
+    _RCReaderPPMData _data;
+};
+
+class RCReaderGroup
+{
+public:
+    /*
+    * Groups multiple channels (e.g. all channels of one receiver) so their values can be read and checked together.
+    * The group stores the configuration of its channels in arrays, so readAll can check all of them in one pass.
+    */
+    RCReaderGroup();
+
+    /*
+    * Removes all channels of the group from the processing
+    */
+    ~RCReaderGroup();
+
+    //the slots and channels are released by the destructor, a copy would release them a second time
+    RCReaderGroup(const RCReaderGroup&) = delete;
+    RCReaderGroup& operator=(const RCReaderGroup&) = delete;
+
+    /*
+    * Adds a channel for the pin to the group. The channel number inside the group is the order in which the channels were added, starting at 0.
+    * The measurement of the pin is shared with all RCReader instances and groups that use the same pin.
+    * 
+    * Parameters:
+    *   - See the RCReader constructor. If the pin can not be used the channel is added anyway and reports RCR_InitFailed.
+    * 
+    * Returns:
+    *   - false if the group is already full (maximum TOTAL_NUM_OF_PC_INTERRUPTS channels), true otherwise.
+    */
+    bool addChannel(RCReaderPin pin, uint16_t timeoutInMilliseconds = 0, uint16_t validMinimumValue = 0, uint16_t validMaximumValue = 0, bool holdLastValueOnFailure = false);
+
+    /*
+    * Adds a channel that shares the measurement of an existing RCReader. The timeout and the valid range of the reader are copied,
+    * later changes of the reader do not affect the group. The RCReader instance can be destroyed while the group is still used.
+    * 
+    * Returns:
+    *   - false if the group is already full (maximum TOTAL_NUM_OF_PC_INTERRUPTS channels), true otherwise.
+    */
+    bool add(RCReader& reader);
+
+    /*
+    * Returns the number of channels in the group.
+    */
+    uint8_t getChannelCount();
+
+    /*
+    * Copies the values of the first n channels of the group in one consistent pass and checks them the same way as RCReader::getMicroseconds does.
+    * All values are guaranteed to be from the same point in time: if a pin change interrupt updated any value while copying, the copy is repeated.
+    * Interrupts stay enabled the whole time.
+    * 
+    * Parameters:
+    *   - out:      Array of at least n elements that receives the values.
+    *   - status:   Array of at least n elements that receives the status flag of each channel. Channels with RCR_InitFailed get the value 0.
+    *   - n:        Number of channels to copy. Limited to the number of channels in the group.
+    * 
+    * Returns:
+    *   - The number of pulses the channels of the group completed, counted up to the copied state. It only changes if
+    *     a channel of the group got a new value, so if it is the same as the one returned by the last call nothing new was received.
+    *     More than 255 pulses of one channel between two calls are not counted completely.
+    */
+    uint16_t snapshot(uint16_t* out, RCRStatus* status, uint8_t n);
+
+    /*
+    * Same as snapshot for all channels of the group, but the status is packed into bitmasks, so checking if all channels are fine
+    * is a single comparison. Bit 0 is channel 0.
+    * 
+    * Parameters:
+    *   - values:       Array with an element for every channel of the group that receives the values. The values follow the same
+    *                   rules as RCReader::getMicroseconds(uint16_t* Value), e.g. the last valid value or the failsafe value is passed on errors.
+    *                   Channels whose pin could not be used get the value 0.
+    *   - errorMask:    Receives the bits of all channels whose status is not RCR_OK.
+    *   - timeoutMask:  Default: NULL
+    *                   If not NULL it receives the bits of the channels with a timeout or in failsafe.
+    * 
+    * Returns:
+    *   - The number of pulses of the group, see snapshot.
+    */
+    uint16_t readAll(uint16_t* values, uint32_t* errorMask, uint32_t* timeoutMask = NULL);
+
+    /*
+    * Returns a bitmask with the bit of every channel set that got a new value since it was last read (see RCReader::hasNewValue).
+    * Bit 0 is channel 0.
+    */
+    uint32_t changedMask();
+
+    /*
+    * Registers a function that is called every time all selected channels of the group got a new value, which marks one complete receiver frame.
+    * This allows to run expensive processing only once per frame. Only one callback can be registered at a time for all groups,
+    * registering a new one replaces the old one. Passing NULL removes the callback, destroying the group that registered it too.
+    * The callback is called from inside the pin change ISR (or from RCReader::poll in deferred mode), so it has to be short.
+    * 
+    * Parameters:
+    *   - callback:     The function to call.
+    *   - channelMask:  Default: all channels
+    *                   Bitmask of the channels that make up one frame. Bit 0 is channel 0.
+    */
+    void setFrameCallback(void (*callback)(void), uint32_t channelMask = 0xFFFFFFFF);
+
+private:
+    //configuration and state of the channels, one array element per channel
+    uint8_t _slots[TOTAL_NUM_OF_PC_INTERRUPTS];
+    uint16_t _validMinimum[TOTAL_NUM_OF_PC_INTERRUPTS];
+    uint16_t _validMaximum[TOTAL_NUM_OF_PC_INTERRUPTS];
+    uint16_t _lastValidValue[TOTAL_NUM_OF_PC_INTERRUPTS];
+    uint16_t _timeoutTicks[TOTAL_NUM_OF_PC_INTERRUPTS];
+    uint8_t _lastUpdateCount[TOTAL_NUM_OF_PC_INTERRUPTS];
+    uint32_t _holdLastValidValue;   //bit per channel
+    uint8_t _channelCount;
+    uint16_t _pulseCount;           //pulses of all channels, counted when they are copied
+
+    bool _addChannel(uint8_t slot, uint16_t timeoutTicks, uint16_t validMinimumValue, uint16_t validMaximumValue, bool holdLastValueOnFailure);
+    //copies the raw values, ages and failsafe states of the first n channels in one consistent pass and returns the pulse count
+    uint16_t _copyChannels(uint16_t* out, uint16_t* ages, bool* failsafe, uint8_t n);
+    //timeout, failsafe and range checks of one channel on the copied values
+    RCRStatus _checkChannel(uint8_t channel, uint16_t age, bool failsafeActive, uint16_t* value);
+};
 
-    //used to translate a pin number to its PCINT number
-    uint8_t _PinToInterruptMap(RCReaderPin pin);
+#if RCREADER_OUTPUT_TIMER != 0
+class RCReaderOutput
+{
+public:
+    /*
+    * Generates a servo signal (20ms period, 0.5us resolution) on one compare output of RCREADER_OUTPUT_TIMER with the hardware PWM,
+    * so no interrupt is needed to generate it. The pulse width is updated right in the pin change ISR that completes a pulse
+    * of one of the inputs (see addInput), so the output follows the receiver without waiting for the main loop.
+    * A new pulse width is used from the next period of the output on.
+    * Until the inputs received their first pulse the output sends the center value.
+    * 
+    * Parameters:
+    *   - channel:  RCR_OUTPUT_A, RCR_OUTPUT_B or RCR_OUTPUT_C. Every channel can only be used by one RCReaderOutput at a time
+    *               and not while its pin is attached to a RCReader (only possible with timer 1, pins 11, 12 and 13).
+    * 
+    *   - minimum:  Default: 1000
+    *               Shortest pulse width in microseconds the output sends, the mixed value is limited to it.
+    * 
+    *   - maximum:  Default: 2000
+    *               Longest pulse width in microseconds the output sends.
+    * 
+    *   - center:   Default: 1500
+    *               Pulse width that is sent if all inputs are at 1500us.
+    */
+    RCReaderOutput(RCROutputChannel channel, uint16_t minimum = 1000, uint16_t maximum = 2000, uint16_t center = 1500);
+
+    /*
+    * Stops the servo signal and sets the pin to LOW
+    */
+    ~RCReaderOutput();
+
+    //the slots and channels are released by the destructor, a copy would release them a second time
+    RCReaderOutput(const RCReaderOutput&) = delete;
+    RCReaderOutput& operator=(const RCReaderOutput&) = delete;
+
+    /*
+    * Adds a RCReader to the mixer of the output. The output is the center plus the sum of the deviations of all inputs
+    * from 1500us, each multiplied with its weight. A RCReader in failsafe (see RCReader::setFailsafe) is mixed with its
+    * failsafe value, so the output moves to it as soon as the failsafe is detected.
+    * 
+    * Parameters:
+    *   - reader:   The RCReader to add.
+    * 
+    *   - weight:   Default: 128
+    *               Fixed point factor with 7 fractional bits: 128 passes the input through, 64 is half of it and -128 reverses it.
+    * 
+    * Returns:
+    *   - RCR_OK if the input was added.
+    *   - RCR_InitFailed if the output or the reader are not valid, or the output already has RCREADER_OUTPUT_INPUTS inputs.
+    */
+    RCRStatus addInput(RCReader& reader, int16_t weight = 128);
+
+    /*
+    * Removes all inputs. The output keeps the last pulse width until it is changed with writeMicroseconds.
+    */
+    void clearInputs();
+
+    /*
+    * Sets the pulse width of the output directly, limited to the minimum and maximum. The next pulse of an input overwrites it.
+    */
+    void writeMicroseconds(uint16_t value);
+
+    /*
+    * Returns the pulse width the output is currently sending, 0 if the output is not valid.
+    */
+    uint16_t readMicroseconds();
+
+private:
+    uint8_t _channel;
 };
+#endif
 
 #endif
\ No newline at end of file
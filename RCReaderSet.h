@@ -0,0 +1,225 @@
+#ifndef RCREADERSET_H_
+#define RCREADERSET_H_
+
+#include "RCReader.h"
+
+/*
+* Compile time variant of the RCReader for firmware where the used pins are known at build time.
+* All pin to port and mask translations are resolved by the compiler, the state of every channel is statically allocated
+* and the generated ISRs only contain fully unrolled code for the pins of the set.
+*
+* Usage:
+*   typedef RCReaderSet<RCR_PIN_A8, RCR_PIN_A9, RCR_PIN_50> Receiver;
+*   RCREADER_SET_ISRS(Receiver)
+*
+* The channel numbers used by the functions are the positions of the pins in the template parameter list.
+* A PCINT port used by a RCReaderSet can not be shared with runtime RCReader instances,
+* but runtime RCReader instances on the other ports keep working.
+*/
+
+//State of one channel of a RCReaderSet
+struct _RCReaderSetChannel
+{
+    bool lastState;
+    RCRTimestamp lastTimestamp;
+    uint16_t currentValue;
+};
+
+//Recursive helpers to combine the masks of all pins of a set at compile time
+template<RCReaderPin... Pins>
+struct _RCReaderSetMasks
+{
+    static constexpr uint8_t pcmsk(uint8_t) { return 0; }
+    static constexpr uint8_t portState(uint8_t) { return 0; }
+    static constexpr bool allValid() { return true; }
+};
+
+template<RCReaderPin First, RCReaderPin... Rest>
+struct _RCReaderSetMasks<First, Rest...>
+{
+    //bits that have to be set in the PCMSK register of the port
+    static constexpr uint8_t pcmsk(uint8_t port)
+    {
+        return (_RCReaderPinToPort(First) == port ? (1 << (_RCReaderPinToInterrupt(First) % 8)) : 0) | _RCReaderSetMasks<Rest...>::pcmsk(port);
+    }
+    //bits of the pins inside the port state the ISR is working with
+    static constexpr uint8_t portState(uint8_t port)
+    {
+        return (_RCReaderPinToPort(First) == port ? _RCReaderPinStateMask(First) : 0) | _RCReaderSetMasks<Rest...>::portState(port);
+    }
+    static constexpr bool allValid()
+    {
+        return _RCReaderPinToInterrupt(First) != 255 && _RCReaderSetMasks<Rest...>::allValid();
+    }
+};
+
+template<RCReaderPin... Pins>
+class RCReaderSet
+{
+    static_assert(sizeof...(Pins) > 0, "A RCReaderSet needs at least one pin");
+    static_assert(_RCReaderSetMasks<Pins...>::allValid(), "Only pins of the RCReaderPin enum can be used with a RCReaderSet");
+
+public:
+    static const uint8_t channelCount = sizeof...(Pins);
+
+    /*
+    * Configures all pins of the set and enables their pin change interrupts.
+    * Has to be called once, usually in setup().
+    */
+    static void begin()
+    {
+        int expand[] = {0, (_configurePin(Pins), 0)...};
+        (void)expand;
+        uint8_t oldSREG = SREG;
+        noInterrupts();
+        for(uint8_t port = 0; port < 3; port++)
+        {
+            _lastPortState[port] = _readPort(port);
+        }
+        PCMSK0 |= _RCReaderSetMasks<Pins...>::pcmsk(0);
+        PCMSK1 |= _RCReaderSetMasks<Pins...>::pcmsk(1);
+        PCMSK2 |= _RCReaderSetMasks<Pins...>::pcmsk(2);
+        PCICR |= (usesPort(0) ? (1 << PCIE0) : 0) | (usesPort(1) ? (1 << PCIE1) : 0) | (usesPort(2) ? (1 << PCIE2) : 0);
+        SREG = oldSREG;
+    }
+
+    /*
+    * Same behavior as RCReader::setValidRange, but the range is used for all channels of the set.
+    */
+    static void setValidRange(uint16_t validMinimumValue, uint16_t validMaximumValue, bool holdLastValueOnFailure = false)
+    {
+        _validMinimum = validMinimumValue;
+        _validMaximum = validMaximumValue;
+        _holdLastValidValue = holdLastValueOnFailure;
+    }
+
+    /*
+    * Same behavior as RCReader::setTimeout, but the timeout is used for all channels of the set.
+    */
+    static void setTimeout(uint16_t timeoutInMilliseconds)
+    {
+        _timeout = timeoutInMilliseconds;
+    }
+
+    /*
+    * Same behavior as RCReader::getMicroseconds(uint16_t* Value) for the given channel.
+    * Returns RCR_InitFailed if the channel number is not part of the set.
+    */
+    static RCRStatus getMicroseconds(uint8_t channel, uint16_t* Value)
+    {
+        if(channel >= channelCount)
+        {
+            return RCR_InitFailed;
+        }
+        //copy the channel with interrupts disabled because the multi byte values can be changed by the ISR at any time
+        uint8_t oldSREG = SREG;
+        noInterrupts();
+        RCRTimestamp lastTimestamp = _channels[channel].lastTimestamp;
+        uint16_t currentValue = _channels[channel].currentValue;
+        SREG = oldSREG;
+
+        if(_timeout != 0 && _RCReaderTicksToMicros(_RCReaderTimestamp() - lastTimestamp) > (uint32_t)_timeout * 1000)
+        {
+            *Value = currentValue;
+            return RCR_Timeout;
+        } else if((currentValue >= _validMinimum && currentValue <= _validMaximum) || (_validMinimum == 0 && _validMaximum == 0))
+        {
+            *Value = currentValue;
+            _lastValidValue[channel] = currentValue;
+            return RCR_OK;
+        }
+        *Value = _holdLastValidValue ? _lastValidValue[channel] : currentValue;
+        return RCR_InvalidValue;
+    }
+
+    /*
+    * Same behavior as RCReader::getMicroseconds() for the given channel.
+    */
+    static int getMicroseconds(uint8_t channel)
+    {
+        uint16_t value;
+        if(getMicroseconds(channel, &value) == RCR_OK || (_holdLastValidValue && channel < channelCount))
+        {
+            return value;
+        }
+        return -1;
+    }
+
+    //true if at least one pin of the set belongs to the given PCINT port
+    static constexpr bool usesPort(uint8_t port)
+    {
+        return _RCReaderSetMasks<Pins...>::pcmsk(port) != 0;
+    }
+
+    //Called by the ISRs generated with RCREADER_SET_ISRS. Do not call this directly.
+    template<uint8_t Port>
+    static inline void handlePort()
+    {
+        uint8_t pinStates = _readPort(Port);
+        uint8_t changedPins = (pinStates ^ _lastPortState[Port]) & _RCReaderSetMasks<Pins...>::portState(Port);
+        _lastPortState[Port] = pinStates;
+        RCRTimestamp now = _RCReaderTimestamp();
+        volatile _RCReaderSetChannel* channel = _channels;
+        //expands to one inlined block per pin, blocks of pins on other ports are removed by the compiler
+        int expand[] = {0, (_handleChannel<Port, Pins>(channel++, changedPins, pinStates, now), 0)...};
+        (void)expand;
+    }
+
+private:
+    static volatile _RCReaderSetChannel _channels[sizeof...(Pins)];
+    static uint8_t _lastPortState[3];
+    static uint16_t _lastValidValue[sizeof...(Pins)];
+    static uint16_t _validMinimum;
+    static uint16_t _validMaximum;
+    static uint16_t _timeout;
+    static bool _holdLastValidValue;
+
+    static void _configurePin(RCReaderPin pin)
+    {
+        pinMode(pin, INPUT);     //Configure pin as input
+        digitalWrite(pin, INPUT_PULLUP); //Enable internal pull up
+    }
+
+    static inline uint8_t _readPort(uint8_t port)
+    {
+        //same layout as the runtime ISRs: PE0 is moved to bit 7 of the PORTJ state
+        return port == 0 ? PINB : port == 1 ? ((PINJ & 0x7F) | ((PINE & 0x01) << 7)) : PINK;
+    }
+
+    template<uint8_t Port, RCReaderPin Pin>
+    static inline void _handleChannel(volatile _RCReaderSetChannel* channel, uint8_t changedPins, uint8_t pinStates, RCRTimestamp now)
+    {
+        if(_RCReaderPinToPort(Pin) != Port || (changedPins & _RCReaderPinStateMask(Pin)) == 0)
+        {
+            return;
+        }
+        if((pinStates & _RCReaderPinStateMask(Pin)) != 0) //Start measurement when the pin changes from LOW to HIGH
+        {
+            channel->lastTimestamp = now;
+            channel->lastState = HIGH;
+        } else if(channel->lastState == HIGH) //Stop measurement and calculate result when pin changes from HIGH to LOW
+        {
+            channel->currentValue = _RCReaderTicksToMicros(now - channel->lastTimestamp);
+            channel->lastState = LOW;
+        }
+    }
+};
+
+template<RCReaderPin... Pins> volatile _RCReaderSetChannel RCReaderSet<Pins...>::_channels[sizeof...(Pins)];
+template<RCReaderPin... Pins> uint8_t RCReaderSet<Pins...>::_lastPortState[3];
+template<RCReaderPin... Pins> uint16_t RCReaderSet<Pins...>::_lastValidValue[sizeof...(Pins)];
+template<RCReaderPin... Pins> uint16_t RCReaderSet<Pins...>::_validMinimum = 0;
+template<RCReaderPin... Pins> uint16_t RCReaderSet<Pins...>::_validMaximum = 0;
+template<RCReaderPin... Pins> uint16_t RCReaderSet<Pins...>::_timeout = 0;
+template<RCReaderPin... Pins> bool RCReaderSet<Pins...>::_holdLastValidValue = false;
+
+/*
+* Generates the pin change ISRs for a RCReaderSet. Has to be used exactly once in the sketch.
+* Ports without pins of the set are passed on to the runtime RCReader instances.
+*/
+#define RCREADER_SET_ISRS(...) \
+    ISR(PCINT0_vect) { if(__VA_ARGS__::usesPort(0)) { __VA_ARGS__::handlePort<0>(); } else { _RCReaderRuntimeISR(0); } } \
+    ISR(PCINT1_vect) { if(__VA_ARGS__::usesPort(1)) { __VA_ARGS__::handlePort<1>(); } else { _RCReaderRuntimeISR(1); } } \
+    ISR(PCINT2_vect) { if(__VA_ARGS__::usesPort(2)) { __VA_ARGS__::handlePort<2>(); } else { _RCReaderRuntimeISR(2); } }
+
+#endif
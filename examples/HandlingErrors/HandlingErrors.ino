@@ -25,6 +25,13 @@ void loop()
     case RCR_Timeout:
       Serial.println("RCR timed out");
     break;
+    case RCR_InitFailed:
+      Serial.println("RCR could not be initialized, check the pin");
+    break;
+    case RCR_QueueOverflow:
+      //only returned by RCReader::poll in deferred mode, never by getMicroseconds
+      Serial.println("RCR lost pin changes");
+    break;
   }
   //add a bit of delay to not flood the serial output
   delay(10);
@@ -6,6 +6,7 @@
 RCReader Trottle(RCR_PIN_A8, 60, 1300, 1800, true);
 
 //Same as above, but without last parameter to showcase the difference
+//Both readers share the measurement of pin A8, only the error handling is done separately
 RCReader Pitch(RCR_PIN_A8, 60, 1300, 1800);
 
 //create an unsigned 16 bit variable to hold our measured value
@@ -0,0 +1,31 @@
+#include <Arduino.h>
+#include <RCReader.h>
+
+//Initialize a PPM reader for Pin A8, 60ms timeout period, and a valid value range from 900 to 2100 for all channels
+RCReaderPPM receiver(RCR_PIN_A8, 60, 900, 2100);
+
+//frame counter of the last printed frame, used to only print new frames
+uint16_t lastFrame = 0;
+
+void setup() 
+{
+  Serial.begin(115200);
+}
+
+void loop()
+{
+  uint16_t frame = receiver.getFrameCounter();
+  if(frame != lastFrame)
+  {
+    lastFrame = frame;
+    //print all channels of the frame in one line, -1 signals an error
+    for(uint8_t channel = 0; channel < receiver.getChannelCount(); channel++)
+    {
+      Serial.print(receiver.getMicroseconds(channel));
+      Serial.print(" ");
+    }
+    Serial.println();
+  }
+  //add a bit of delay to not flood the serial output
+  delay(10);
+}
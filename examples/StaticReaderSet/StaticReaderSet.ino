@@ -0,0 +1,28 @@
+#include <Arduino.h>
+#include <RCReaderSet.h>
+
+//All pins are known at compile time, so the ISRs are generated for exactly these three channels
+typedef RCReaderSet<RCR_PIN_A8, RCR_PIN_A9, RCR_PIN_50> Receiver;
+RCREADER_SET_ISRS(Receiver)
+
+void setup() 
+{
+  Serial.begin(115200);
+  //Valid value range from 1000 to 2000 and a 60ms timeout period for all channels
+  Receiver::setValidRange(1000, 2000);
+  Receiver::setTimeout(60);
+  Receiver::begin();
+}
+
+void loop()
+{
+  //print all channels in one line, -1 signals an error
+  for(uint8_t channel = 0; channel < Receiver::channelCount; channel++)
+  {
+    Serial.print(Receiver::getMicroseconds(channel));
+    Serial.print(" ");
+  }
+  Serial.println();
+  //add a bit of delay to not flood the serial output
+  delay(10);
+}
@@ -0,0 +1,34 @@
+#include <Arduino.h>
+#include <RCReader.h>
+
+//Firmware for the simavr ISR benchmark (see extras/benchmark/Makefile).
+//BENCH_READERS is set by the Makefile, one firmware is built for every number of readers.
+#ifndef BENCH_READERS
+    #define BENCH_READERS 6
+#endif
+
+//Same order as the pin table of IsrCycles.cpp: PORTK, PORTB, then the PCINT1 pins
+const RCReaderPin pins[] = {RCR_PIN_A8, RCR_PIN_A9, RCR_PIN_A10, RCR_PIN_A11, RCR_PIN_A12, RCR_PIN_A13, RCR_PIN_A14, RCR_PIN_A15,
+                            RCR_PIN_53, RCR_PIN_52, RCR_PIN_51, RCR_PIN_50, RCR_PIN_10, RCR_PIN_11, RCR_PIN_12, RCR_PIN_13,
+                            RCR_PIN_0, RCR_PIN_15};
+
+RCReader* readers[BENCH_READERS];
+//keeps the compiler from removing the reads in the loop
+volatile uint16_t sink;
+
+void setup()
+{
+  for(uint8_t i = 0; i < BENCH_READERS; i++)
+  {
+    readers[i] = new RCReader(pins[i], 50, 900, 2100);
+  }
+}
+
+void loop()
+{
+  //reading all channels like a normal sketch does, so the blocking time of the main loop is part of the measurement
+  for(uint8_t i = 0; i < BENCH_READERS; i++)
+  {
+    sink += readers[i]->getMicroseconds();
+  }
+}
@@ -0,0 +1,274 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "avr_ioport.h"
+
+//Runs the IsrBenchmark firmware in simavr, drives PWM signals into the pins of the readers
+//and measures every pin change ISR from its vector to the return.
+//
+//Usage: IsrCycles <report.json> <table.md> <readers>:<firmware.elf> ...
+
+#define CPU_FREQUENCY 16000000
+#define CYCLES_PER_MICROSECOND (CPU_FREQUENCY / 1000000)
+//byte addresses of the PCINT0-2 vectors (vectors 9-11, 4 bytes each)
+#define PCINT_VECTOR_FIRST (9 * 4)
+#define PCINT_VECTOR_LAST (11 * 4)
+#define WARMUP_MICROSECONDS 100000
+#define FRAMES 50
+#define FRAME_LENGTH 20000
+
+//Pins in the same order as in IsrBenchmark.ino
+struct BenchPin
+{
+    char port;
+    uint8_t bit;
+};
+
+static const BenchPin _pins[] = {
+    {'K', 0}, {'K', 1}, {'K', 2}, {'K', 3}, {'K', 4}, {'K', 5}, {'K', 6}, {'K', 7},
+    {'B', 0}, {'B', 1}, {'B', 2}, {'B', 3}, {'B', 4}, {'B', 5}, {'B', 6}, {'B', 7},
+    {'E', 0}, {'J', 0}
+};
+
+struct Edge
+{
+    uint32_t time;      //microseconds after the end of the warm up
+    uint8_t pin;
+    uint8_t level;
+
+    bool operator<(const Edge& other) const { return time < other.time; }
+};
+
+struct Result
+{
+    const char* pattern;
+    uint32_t isrCalls;
+    uint64_t isrCyclesMin;
+    uint64_t isrCyclesMax;
+    uint64_t isrCyclesTotal;
+    uint64_t maxBlockingCycles;
+};
+
+//Watches the CPU after every instruction
+struct Monitor
+{
+    bool measuring;
+    bool inIsr;
+    uint16_t isrStackPointer;
+    uint64_t isrStart;
+    bool blocked;
+    uint64_t blockedSince;
+    Result* result;
+};
+
+static uint16_t _stackPointer(avr_t* avr)
+{
+    return avr->data[R_SPL] | (avr->data[R_SPH] << 8);
+}
+
+static void _step(avr_t* avr, Monitor* monitor)
+{
+    uint64_t cycleBefore = avr->cycle;
+    int state = avr_run(avr);
+    if(state == cpu_Done || state == cpu_Crashed)
+    {
+        fprintf(stderr, "firmware stopped (state %d)\n", state);
+        exit(1);
+    }
+    if(!monitor->measuring)
+    {
+        return;
+    }
+    Result* result = monitor->result;
+    uint16_t stackPointer = _stackPointer(avr);
+    if(!monitor->inIsr && avr->pc >= PCINT_VECTOR_FIRST && avr->pc <= PCINT_VECTOR_LAST && (avr->pc % 4) == 0)
+    {
+        //the return address was just pushed, the ISR is done once the stack is above this again
+        monitor->inIsr = true;
+        monitor->isrStackPointer = stackPointer;
+        monitor->isrStart = avr->cycle;
+    } else if(monitor->inIsr && stackPointer > monitor->isrStackPointer)
+    {
+        uint64_t cycles = avr->cycle - monitor->isrStart;
+        monitor->inIsr = false;
+        result->isrCalls++;
+        result->isrCyclesTotal += cycles;
+        result->isrCyclesMin = std::min(result->isrCyclesMin, cycles);
+        result->isrCyclesMax = std::max(result->isrCyclesMax, cycles);
+    }
+    //time with the global interrupt flag cleared, in ISRs as well as in critical sections of the main loop
+    if(!avr->sreg[S_I] && !monitor->blocked)
+    {
+        monitor->blocked = true;
+        monitor->blockedSince = cycleBefore;
+    } else if(avr->sreg[S_I] && monitor->blocked)
+    {
+        monitor->blocked = false;
+        result->maxBlockingCycles = std::max(result->maxBlockingCycles, avr->cycle - monitor->blockedSince);
+    }
+}
+
+static void _runUntil(avr_t* avr, Monitor* monitor, uint64_t cycle)
+{
+    while(avr->cycle < cycle)
+    {
+        _step(avr, monitor);
+    }
+}
+
+//Receiver like signal: every channel starts when the one before ended
+static std::vector<Edge> _receiverPattern(uint8_t readers)
+{
+    std::vector<Edge> edges;
+    for(uint32_t frame = 0; frame < FRAMES; frame++)
+    {
+        uint32_t time = frame * FRAME_LENGTH;
+        for(uint8_t pin = 0; pin < readers; pin++)
+        {
+            uint16_t width = 1000 + (pin * 50 + frame * 7) % 1000;
+            edges.push_back(Edge{time, pin, 1});
+            edges.push_back(Edge{time + width, pin, 0});
+            //only 8 channels fit into one frame, the others run in parallel like a second receiver
+            time = (pin % 8 == 7) ? frame * FRAME_LENGTH : time + width;
+        }
+    }
+    std::stable_sort(edges.begin(), edges.end());
+    return edges;
+}
+
+//Worst case: all pulses start at the same time, so the ISRs have to handle many changed pins at once
+static std::vector<Edge> _simultaneousPattern(uint8_t readers)
+{
+    std::vector<Edge> edges;
+    for(uint32_t frame = 0; frame < FRAMES; frame++)
+    {
+        uint32_t time = frame * FRAME_LENGTH;
+        for(uint8_t pin = 0; pin < readers; pin++)
+        {
+            edges.push_back(Edge{time, pin, 1});
+        }
+        for(uint8_t pin = 0; pin < readers; pin++)
+        {
+            edges.push_back(Edge{time + 1000 + pin * 40u, pin, 0});
+        }
+    }
+    std::stable_sort(edges.begin(), edges.end());
+    return edges;
+}
+
+static bool _runPattern(const char* firmwarePath, uint8_t readers, const char* pattern, const std::vector<Edge>& edges, Result* result,
+                        uint32_t* flashSize, uint32_t* ramSize)
+{
+    elf_firmware_t firmware;
+    memset(&firmware, 0, sizeof(firmware));
+    if(elf_read_firmware(firmwarePath, &firmware) != 0)
+    {
+        fprintf(stderr, "can not read %s\n", firmwarePath);
+        return false;
+    }
+    avr_t* avr = avr_make_mcu_by_name("atmega2560");
+    if(avr == NULL || avr_init(avr) != 0)
+    {
+        fprintf(stderr, "can not create an atmega2560\n");
+        return false;
+    }
+    firmware.frequency = CPU_FREQUENCY;
+    avr_load_firmware(avr, &firmware);
+    *flashSize = firmware.flashsize;
+    *ramSize = firmware.datasize + firmware.bsssize;
+
+    avr_irq_t* irqs[sizeof(_pins) / sizeof(_pins[0])];
+    for(uint8_t pin = 0; pin < readers; pin++)
+    {
+        irqs[pin] = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(_pins[pin].port), _pins[pin].bit);
+        avr_raise_irq(irqs[pin], 0);
+    }
+
+    *result = Result{pattern, 0, UINT64_MAX, 0, 0, 0};
+    Monitor monitor = {false, false, 0, 0, false, 0, result};
+    //let the Arduino core and setup() run before anything is measured
+    _runUntil(avr, &monitor, (uint64_t)WARMUP_MICROSECONDS * CYCLES_PER_MICROSECOND);
+    monitor.measuring = true;
+    uint64_t start = avr->cycle;
+    for(const Edge& edge : edges)
+    {
+        _runUntil(avr, &monitor, start + (uint64_t)edge.time * CYCLES_PER_MICROSECOND);
+        avr_raise_irq(irqs[edge.pin], edge.level);
+    }
+    _runUntil(avr, &monitor, avr->cycle + (uint64_t)FRAME_LENGTH * CYCLES_PER_MICROSECOND);
+    avr_terminate(avr);
+    if(result->isrCalls == 0)
+    {
+        result->isrCyclesMin = 0;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 4)
+    {
+        fprintf(stderr, "usage: %s <report.json> <table.md> <readers>:<firmware.elf> ...\n", argv[0]);
+        return 2;
+    }
+    FILE* json = fopen(argv[1], "w");
+    FILE* table = fopen(argv[2], "w");
+    if(json == NULL || table == NULL)
+    {
+        fprintf(stderr, "can not open the output files\n");
+        return 1;
+    }
+    fprintf(json, "{\n  \"mcu\": \"atmega2560\",\n  \"frequency\": %d,\n  \"frames\": %d,\n  \"results\": [", CPU_FREQUENCY, FRAMES);
+    fprintf(table, "| Instances (num of pins) | ISR cycles Min | ISR cycles Avg | ISR cycles Max | Worst case ISR | Max blocking time |\n");
+    fprintf(table, "|------------------------:|:--------------:|:--------------:|:--------------:|:--------------:|:-----------------:|\n");
+    bool first = true;
+    for(int arg = 3; arg < argc; arg++)
+    {
+        char* separator = strchr(argv[arg], ':');
+        if(separator == NULL)
+        {
+            fprintf(stderr, "invalid argument %s\n", argv[arg]);
+            return 2;
+        }
+        *separator = '\0';
+        uint8_t readers = atoi(argv[arg]);
+        const char* firmwarePath = separator + 1;
+        Result results[2];
+        uint32_t flashSize, ramSize;
+        if(!_runPattern(firmwarePath, readers, "receiver", _receiverPattern(readers), &results[0], &flashSize, &ramSize) ||
+           !_runPattern(firmwarePath, readers, "simultaneous", _simultaneousPattern(readers), &results[1], &flashSize, &ramSize))
+        {
+            return 1;
+        }
+        for(const Result& result : results)
+        {
+            fprintf(json, "%s\n    {\"readers\": %d, \"pattern\": \"%s\", \"flash_bytes\": %u, \"ram_bytes\": %u, \"isr_calls\": %u, "
+                          "\"isr_cycles\": {\"min\": %llu, \"avg\": %llu, \"max\": %llu}, \"max_blocking_cycles\": %llu}",
+                    first ? "" : ",", readers, result.pattern, flashSize, ramSize, result.isrCalls,
+                    (unsigned long long)result.isrCyclesMin,
+                    (unsigned long long)(result.isrCalls ? result.isrCyclesTotal / result.isrCalls : 0),
+                    (unsigned long long)result.isrCyclesMax, (unsigned long long)result.maxBlockingCycles);
+            first = false;
+        }
+        //the table shows the receiver pattern, the worst case column is the simultaneous one
+        fprintf(table, "|%24s| %14llu | %14llu | %14llu | %11.1fus | %15.1fus |\n",
+                (std::string("**") + argv[arg] + (readers == 1 ? " pin**" : " pins**")).c_str(),
+                (unsigned long long)results[0].isrCyclesMin,
+                (unsigned long long)(results[0].isrCalls ? results[0].isrCyclesTotal / results[0].isrCalls : 0),
+                (unsigned long long)results[0].isrCyclesMax,
+                (double)results[1].isrCyclesMax / CYCLES_PER_MICROSECOND,
+                (double)std::max(results[0].maxBlockingCycles, results[1].maxBlockingCycles) / CYCLES_PER_MICROSECOND);
+        printf("%2d readers: %u ISR calls, %llu-%llu cycles\n", readers, results[0].isrCalls,
+               (unsigned long long)results[0].isrCyclesMin, (unsigned long long)results[0].isrCyclesMax);
+    }
+    fprintf(json, "\n  ]\n}\n");
+    fclose(json);
+    fclose(table);
+    return 0;
+}
@@ -0,0 +1,169 @@
+#include "SignalGenerator.h"
+
+SignalGenerator::SignalGenerator()
+{
+    _signalCount = 0;
+    _time = 0;
+    _jitter = 0;
+    _random = 1;
+    _edgeCount = 0;
+    _edgeHook = NULL;
+}
+
+uint8_t SignalGenerator::_add(uint8_t pin, bool ppm, uint32_t period, uint32_t offset)
+{
+    Signal* signal = &_signals[_signalCount];
+    signal->pin = pin;
+    signal->ppm = ppm;
+    signal->running = true;
+    signal->level = LOW;
+    signal->period = period;
+    signal->pulseLength = 0;
+    signal->count = 0;
+    signal->channel = 0;
+    signal->periodStart = _time + offset;
+    signal->nextEdge = _time + offset;
+    return _signalCount++;
+}
+
+uint8_t SignalGenerator::addPWM(uint8_t pin, uint16_t pulseWidth, uint32_t period, uint32_t offset)
+{
+    uint8_t number = _add(pin, false, period, offset);
+    _signals[number].values[0] = pulseWidth;
+    _signals[number].count = 1;
+    simSetPin(pin, LOW);
+    return number;
+}
+
+uint8_t SignalGenerator::addReceiver(const uint8_t* pins, const uint16_t* pulseWidths, uint8_t count, uint32_t period)
+{
+    uint8_t first = _signalCount;
+    uint32_t offset = 0;
+    for(uint8_t i = 0; i < count; i++)
+    {
+        addPWM(pins[i], pulseWidths[i], period, offset);
+        offset += pulseWidths[i];
+    }
+    return first;
+}
+
+uint8_t SignalGenerator::addPPM(uint8_t pin, const uint16_t* values, uint8_t count, uint32_t frameLength, uint16_t pulseLength)
+{
+    uint8_t number = _add(pin, true, frameLength, 0);
+    Signal* signal = &_signals[number];
+    signal->pulseLength = pulseLength;
+    signal->count = count;
+    for(uint8_t i = 0; i < count; i++)
+    {
+        signal->values[i] = values[i];
+    }
+    //the idle level of a PPM signal is high, every channel starts with a low pulse
+    signal->level = HIGH;
+    simSetPin(pin, HIGH);
+    return number;
+}
+
+void SignalGenerator::setValue(uint8_t signal, uint16_t value, uint8_t channel)
+{
+    _signals[signal].values[channel] = value;
+}
+
+void SignalGenerator::setJitter(uint16_t jitter, uint32_t seed)
+{
+    _jitter = jitter;
+    _random = seed;
+}
+
+void SignalGenerator::stop(uint8_t signal)
+{
+    _signals[signal].running = false;
+}
+
+void SignalGenerator::setEdgeHook(void (*hook)(void))
+{
+    _edgeHook = hook;
+}
+
+uint32_t SignalGenerator::edgeCount() const
+{
+    return _edgeCount;
+}
+
+uint16_t SignalGenerator::_applyJitter(uint16_t value)
+{
+    if(_jitter == 0)
+    {
+        return value;
+    }
+    //linear congruential generator, so every run produces the same signal
+    _random = _random * 1103515245 + 12345;
+    int32_t offset = (int32_t)((_random >> 16) % (2 * _jitter + 1)) - _jitter;
+    return value + offset;
+}
+
+void SignalGenerator::_edge(Signal* signal)
+{
+    signal->level = !signal->level;
+    simSetPin(signal->pin, signal->level);
+    _edgeCount++;
+    if(!signal->ppm)
+    {
+        if(signal->level == HIGH)
+        {
+            signal->periodStart = signal->nextEdge;
+            signal->nextEdge += _applyJitter(signal->values[0]);
+        } else
+        {
+            signal->nextEdge = signal->periodStart + signal->period;
+        }
+        return;
+    }
+    if(signal->level == LOW)
+    {
+        signal->nextEdge += signal->pulseLength;
+        return;
+    }
+    //rising edge: the high phase lasts until the next channel starts, after the last channel the sync gap fills up the frame
+    if(signal->channel == 0)
+    {
+        signal->periodStart = signal->nextEdge - signal->pulseLength;
+    }
+    if(signal->channel < signal->count)
+    {
+        signal->nextEdge += _applyJitter(signal->values[signal->channel]) - signal->pulseLength;
+        signal->channel++;
+    } else
+    {
+        signal->nextEdge = signal->periodStart + signal->period;
+        signal->channel = 0;
+    }
+}
+
+void SignalGenerator::run(uint32_t microseconds)
+{
+    uint64_t end = _time + microseconds;
+    while(true)
+    {
+        Signal* next = NULL;
+        for(uint8_t i = 0; i < _signalCount; i++)
+        {
+            if(_signals[i].running && (next == NULL || _signals[i].nextEdge < next->nextEdge))
+            {
+                next = &_signals[i];
+            }
+        }
+        if(next == NULL || next->nextEdge > end)
+        {
+            break;
+        }
+        simAdvanceMicros(next->nextEdge - _time);
+        _time = next->nextEdge;
+        _edge(next);
+        if(_edgeHook != NULL)
+        {
+            _edgeHook();
+        }
+    }
+    simAdvanceMicros(end - _time);
+    _time = end;
+}
@@ -0,0 +1,85 @@
+#ifndef SIGNALGENERATOR_H_
+#define SIGNALGENERATOR_H_
+
+#include "SimulationHAL.h"
+
+//Number of signals one generator can drive
+#define SIM_MAX_SIGNALS 19
+#define SIM_MAX_PPM_CHANNELS 16
+
+/*
+* Drives the pins of the simulated board with receiver signals and moves the time forward from edge to edge.
+* PWM signals repeat their pulse every period, PPM signals send a frame of channel values followed by a sync gap.
+* Signals on the same port that change at the same time cause one pin change interrupt each, in the order they were added.
+*/
+class SignalGenerator
+{
+public:
+    SignalGenerator();
+
+    /*
+    * Adds a PWM signal. The first rising edge is offset microseconds after the current time.
+    * Returns the number of the signal that is used by the other functions.
+    */
+    uint8_t addPWM(uint8_t pin, uint16_t pulseWidth, uint32_t period = 20000, uint32_t offset = 0);
+
+    /*
+    * Adds one PWM signal per pin like a typical receiver: every channel starts when the one before ended.
+    * Returns the number of the first signal, the others follow in order.
+    */
+    uint8_t addReceiver(const uint8_t* pins, const uint16_t* pulseWidths, uint8_t count, uint32_t period = 20000);
+
+    /*
+    * Adds a PPM sum signal. Every channel is a low pulse of pulseLength microseconds followed by a high phase,
+    * so the time between two rising edges is the channel value. The frame is filled up with the sync gap.
+    */
+    uint8_t addPPM(uint8_t pin, const uint16_t* values, uint8_t count, uint32_t frameLength = 22500, uint16_t pulseLength = 300);
+
+    //Changes the pulse width of a PWM signal or one channel value of a PPM signal, used from the next pulse on
+    void setValue(uint8_t signal, uint16_t value, uint8_t channel = 0);
+
+    //Every pulse width is changed by a random amount of up to +-jitter microseconds
+    void setJitter(uint16_t jitter, uint32_t seed = 1);
+
+    //Stops a signal and leaves the pin at its current level
+    void stop(uint8_t signal);
+
+    //Generates all edges of the next microseconds and leaves the time at the end of the duration
+    void run(uint32_t microseconds);
+
+    //Called after every edge, e.g. to poll the library in deferred mode
+    void setEdgeHook(void (*hook)(void));
+
+    //Number of edges generated so far
+    uint32_t edgeCount() const;
+
+private:
+    struct Signal
+    {
+        uint8_t pin;
+        bool ppm;
+        bool running;
+        bool level;
+        uint32_t period;
+        uint16_t pulseLength;
+        uint16_t values[SIM_MAX_PPM_CHANNELS];
+        uint8_t count;
+        uint8_t channel;        //PPM channel of the next edge
+        uint64_t periodStart;   //time of the rising edge that started the current period
+        uint64_t nextEdge;
+    };
+
+    Signal _signals[SIM_MAX_SIGNALS];
+    uint8_t _signalCount;
+    uint64_t _time;
+    uint16_t _jitter;
+    uint32_t _random;
+    uint32_t _edgeCount;
+    void (*_edgeHook)(void);
+
+    uint8_t _add(uint8_t pin, bool ppm, uint32_t period, uint32_t offset);
+    uint16_t _applyJitter(uint16_t value);
+    void _edge(Signal* signal);
+};
+
+#endif
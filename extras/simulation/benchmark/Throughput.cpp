@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <chrono>
+#include "SignalGenerator.h"
+#include "RCReader.h"
+
+//Measures the host time the library needs per pin change for 1 to 18 readers.
+//The absolute numbers say nothing about the AVR, but changes of the decoding logic show up as relative differences.
+
+static const RCReaderPin _pins[] = {RCR_PIN_A8, RCR_PIN_A9, RCR_PIN_A10, RCR_PIN_A11, RCR_PIN_A12, RCR_PIN_A13, RCR_PIN_A14, RCR_PIN_A15,
+                                    RCR_PIN_53, RCR_PIN_52, RCR_PIN_51, RCR_PIN_50, RCR_PIN_10, RCR_PIN_11, RCR_PIN_12, RCR_PIN_13,
+                                    RCR_PIN_0, RCR_PIN_15};
+
+static void _poll()
+{
+    RCReader::poll();
+}
+
+//Runs the signal without and with the readers attached, the difference is the time spent in the library.
+//The fastest of several runs is used to filter out the noise of the host.
+static double _measure(uint8_t readerCount, uint32_t duration)
+{
+    double seconds[2] = {1e9, 1e9};
+    uint32_t edges = 0;
+    for(uint8_t run = 0; run < 10; run++)
+    {
+        uint8_t withReaders = run % 2;
+        simReset();
+        RCReader* readers[TOTAL_NUM_OF_PC_INTERRUPTS];
+        for(uint8_t i = 0; i < readerCount; i++)
+        {
+            readers[i] = withReaders ? new RCReader(_pins[i]) : NULL;
+        }
+        //without readers the pin change interrupts are disabled, so only the generator itself is measured
+        SignalGenerator generator;
+        generator.setEdgeHook(_poll);
+        for(uint8_t i = 0; i < readerCount; i++)
+        {
+            generator.addPWM(_pins[i], 1000 + i * 50, 20000, (i % 8) * 2100);
+        }
+        generator.setJitter(4);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        generator.run(duration);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        seconds[withReaders] = (elapsed < seconds[withReaders]) ? elapsed : seconds[withReaders];
+        edges = generator.edgeCount();
+        for(uint8_t i = 0; i < readerCount; i++)
+        {
+            delete readers[i];
+        }
+    }
+    double library = seconds[1] - seconds[0];
+    return (library > 0 ? library : 0) * 1e9 / edges;
+}
+
+int main()
+{
+    //simulated time per run, long enough to get stable results
+    const uint32_t duration = 5000000;
+    printf("readers  ns/edge\n");
+    for(uint8_t readers = 1; readers <= TOTAL_NUM_OF_PC_INTERRUPTS; readers++)
+    {
+        printf("%7d  %7.1f\n", readers, _measure(readers, duration));
+    }
+    return 0;
+}
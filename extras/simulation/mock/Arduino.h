@@ -0,0 +1,86 @@
+#ifndef SIMULATION_ARDUINO_H_
+#define SIMULATION_ARDUINO_H_
+
+//Minimal replacement of the Arduino core for building the library on the host.
+//Only what the library and its examples use is provided. Pins, time and interrupts are controlled by SimulationHAL.h.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define A8 62
+#define A9 63
+#define A10 64
+#define A11 65
+#define A12 66
+#define A13 67
+#define A14 68
+#define A15 69
+
+#define noInterrupts() cli()
+#define interrupts() sei()
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+unsigned long micros();
+unsigned long millis();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+//Output is collected in memory so tests can check what a sketch printed
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t print(const char* str);
+    size_t print(char c);
+    size_t print(long n);
+    size_t print(unsigned long n);
+    size_t print(int n) { return print((long)n); }
+    size_t print(unsigned int n) { return print((unsigned long)n); }
+    size_t println();
+    template<typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+};
+
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long) {}
+    virtual size_t write(uint8_t c);
+    using Print::write;
+    //everything written since the last call of clearOutput
+    const uint8_t* output() const { return _buffer; }
+    size_t outputLength() const { return _length; }
+    void clearOutput() { _length = 0; }
+
+private:
+    uint8_t _buffer[8192];
+    size_t _length = 0;
+};
+
+extern HardwareSerial Serial;
+
+#endif
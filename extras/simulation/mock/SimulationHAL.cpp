@@ -0,0 +1,360 @@
+#include "SimulationHAL.h"
+
+volatile uint8_t SREG = 0x80;
+volatile uint8_t PINB, PINE, PINJ, PINK;
+volatile uint8_t PCICR, PCIFR, PCMSK0, PCMSK1, PCMSK2;
+volatile uint8_t TCNT0, OCR0A, TIMSK0, TIFR0;
+
+#define _SIM_TIMER16_STORAGE(n) \
+    volatile uint8_t TCCR##n##A, TCCR##n##B, TIMSK##n, TIFR##n; \
+    volatile uint16_t TCNT##n, ICR##n, OCR##n##A, OCR##n##B, OCR##n##C;
+
+_SIM_TIMER16_STORAGE(1)
+_SIM_TIMER16_STORAGE(3)
+_SIM_TIMER16_STORAGE(4)
+_SIM_TIMER16_STORAGE(5)
+
+HardwareSerial Serial;
+
+//The vectors are weak, so a test binary only needs to contain the ISRs it uses
+extern "C" void PCINT0_vect(void) __attribute__((weak));
+extern "C" void PCINT1_vect(void) __attribute__((weak));
+extern "C" void PCINT2_vect(void) __attribute__((weak));
+extern "C" void TIMER0_COMPA_vect(void) __attribute__((weak));
+extern "C" void TIMER1_OVF_vect(void) __attribute__((weak));
+extern "C" void TIMER3_OVF_vect(void) __attribute__((weak));
+extern "C" void TIMER4_OVF_vect(void) __attribute__((weak));
+extern "C" void TIMER5_OVF_vect(void) __attribute__((weak));
+
+//Connection of an Arduino pin to its input register and pin change interrupt
+struct _SimPin
+{
+    uint8_t pin;
+    volatile uint8_t* inputRegister;
+    uint8_t bit;
+    uint8_t pcint;
+};
+
+static const _SimPin _simPins[] = {
+    {53, &PINB, 0, 0}, {52, &PINB, 1, 1}, {51, &PINB, 2, 2}, {50, &PINB, 3, 3},
+    {10, &PINB, 4, 4}, {11, &PINB, 5, 5}, {12, &PINB, 6, 6}, {13, &PINB, 7, 7},
+    {0, &PINE, 0, 8}, {15, &PINJ, 0, 9}, {14, &PINJ, 1, 10},
+    {A8, &PINK, 0, 16}, {A9, &PINK, 1, 17}, {A10, &PINK, 2, 18}, {A11, &PINK, 3, 19},
+    {A12, &PINK, 4, 20}, {A13, &PINK, 5, 21}, {A14, &PINK, 6, 22}, {A15, &PINK, 7, 23}
+};
+
+//16 bit timer with the registers it is using
+struct _SimTimer
+{
+    volatile uint8_t* tccrb;
+    volatile uint8_t* timsk;
+    volatile uint8_t* tifr;
+    volatile uint16_t* tcnt;
+    void (*overflowVector)(void);
+    uint8_t subTicks;   //16MHz clock cycles that did not make up a complete timer tick yet
+};
+
+static _SimTimer _simTimers[] = {
+    {&TCCR1B, &TIMSK1, &TIFR1, &TCNT1, TIMER1_OVF_vect, 0},
+    {&TCCR3B, &TIMSK3, &TIFR3, &TCNT3, TIMER3_OVF_vect, 0},
+    {&TCCR4B, &TIMSK4, &TIFR4, &TCNT4, TIMER4_OVF_vect, 0},
+    {&TCCR5B, &TIMSK5, &TIFR5, &TCNT5, TIMER5_OVF_vect, 0}
+};
+
+static uint64_t _simTime = 0;
+static uint8_t _simTimer0SubTicks = 0;
+static uint32_t _simInterruptCounts[3] = {0};
+
+//Runs an interrupt vector the way the CPU does: the global interrupt flag is cleared while it runs and set again by reti
+static void _simCallVector(void (*vector)(void))
+{
+    if(vector == NULL)
+    {
+        return;
+    }
+    SREG &= (uint8_t)~0x80;
+    vector();
+    SREG |= 0x80;
+}
+
+//Clock cycles per timer tick for the clock select bits of TCCRnB, 0 if the timer is stopped
+static uint16_t _simPrescaler(uint8_t tccrb)
+{
+    switch(tccrb & 0x07)
+    {
+        case 1: return 1;
+        case 2: return 8;
+        case 3: return 64;
+        case 4: return 256;
+        case 5: return 1024;
+        default: return 0;
+    }
+}
+
+static void _simAdvanceTimer(_SimTimer* timer, uint64_t cycles)
+{
+    uint16_t prescaler = _simPrescaler(*timer->tccrb);
+    if(prescaler == 0)
+    {
+        return;
+    }
+    uint64_t ticks = (cycles + timer->subTicks) / prescaler;
+    timer->subTicks = (cycles + timer->subTicks) % prescaler;
+    while(ticks > 0)
+    {
+        uint32_t untilOverflow = 0x10000 - *timer->tcnt;
+        if(ticks < untilOverflow)
+        {
+            *timer->tcnt += ticks;
+            return;
+        }
+        ticks -= untilOverflow;
+        *timer->tcnt = 0;
+        if((*timer->timsk & 0x01) != 0 && (SREG & 0x80) != 0)
+        {
+            _simCallVector(timer->overflowVector);  //the flag is cleared by the hardware when the vector is executed
+        } else
+        {
+            *timer->tifr |= 0x01;
+        }
+    }
+}
+
+//Timer0 always runs with the prescaler of 64 like on an Arduino, so the compare match A happens every 1.024ms
+static void _simAdvanceTimer0(uint64_t cycles)
+{
+    uint64_t ticks = (cycles + _simTimer0SubTicks) / 64;
+    _simTimer0SubTicks = (cycles + _simTimer0SubTicks) % 64;
+    while(ticks > 0)
+    {
+        uint16_t untilMatch = (uint8_t)(OCR0A - TCNT0);
+        if(untilMatch == 0)
+        {
+            untilMatch = 256;
+        }
+        if(ticks < untilMatch)
+        {
+            TCNT0 += ticks;
+            return;
+        }
+        ticks -= untilMatch;
+        TCNT0 = OCR0A;
+        if((TIMSK0 & (1 << OCIE0A)) != 0 && (SREG & 0x80) != 0)
+        {
+            _simCallVector(TIMER0_COMPA_vect);
+        } else
+        {
+            TIFR0 |= (1 << OCF0A);
+        }
+    }
+}
+
+static void _simRunPinChangeISR(uint8_t port)
+{
+    _simInterruptCounts[port]++;
+    switch(port)
+    {
+        case 0: _simCallVector(PCINT0_vect); break;
+        case 1: _simCallVector(PCINT1_vect); break;
+        default: _simCallVector(PCINT2_vect); break;
+    }
+}
+
+void simReset()
+{
+    SREG = 0x80;
+    PINB = PINE = PINJ = PINK = 0;
+    PCICR = PCIFR = PCMSK0 = PCMSK1 = PCMSK2 = 0;
+    for(_SimTimer& timer : _simTimers)
+    {
+        *timer.tccrb = 0;
+        *timer.timsk = 0;
+        *timer.tifr = 0;
+        *timer.tcnt = 0;
+        timer.subTicks = 0;
+    }
+    TCCR1A = TCCR3A = TCCR4A = TCCR5A = 0;
+    ICR1 = ICR3 = ICR4 = ICR5 = 0;
+    OCR1A = OCR1B = OCR1C = OCR3A = OCR3B = OCR3C = 0;
+    OCR4A = OCR4B = OCR4C = OCR5A = OCR5B = OCR5C = 0;
+    TCNT0 = OCR0A = TIMSK0 = TIFR0 = 0;
+    _simTimer0SubTicks = 0;
+    _simTime = 0;
+    for(uint8_t port = 0; port < 3; port++)
+    {
+        _simInterruptCounts[port] = 0;
+    }
+    Serial.clearOutput();
+}
+
+void simAdvanceMicros(uint32_t microseconds)
+{
+    _simTime += microseconds;
+    _simAdvanceTimer0((uint64_t)microseconds * 16);
+    for(_SimTimer& timer : _simTimers)
+    {
+        _simAdvanceTimer(&timer, (uint64_t)microseconds * 16);
+    }
+}
+
+void simSetMicros(uint32_t microseconds)
+{
+    simAdvanceMicros(microseconds - (uint32_t)_simTime);
+}
+
+void simSetPin(uint8_t pin, uint8_t level)
+{
+    for(const _SimPin& simPin : _simPins)
+    {
+        if(simPin.pin != pin)
+        {
+            continue;
+        }
+        uint8_t oldState = *simPin.inputRegister;
+        if(level == HIGH)
+        {
+            *simPin.inputRegister |= (1 << simPin.bit);
+        } else
+        {
+            *simPin.inputRegister &= ~(1 << simPin.bit);
+        }
+        uint8_t port = simPin.pcint / 8;
+        volatile uint8_t* pcmsk = (port == 0) ? &PCMSK0 : (port == 1) ? &PCMSK1 : &PCMSK2;
+        if(oldState == *simPin.inputRegister || (*pcmsk & (1 << (simPin.pcint % 8))) == 0)
+        {
+            return;
+        }
+        if((PCICR & (1 << port)) != 0)
+        {
+            _simRunPinChangeISR(port);
+        } else
+        {
+            PCIFR |= (1 << port);
+        }
+        return;
+    }
+}
+
+void simSetPortState(uint8_t port, uint8_t state)
+{
+    switch(port)
+    {
+        case 0:
+            PINB = state;
+            break;
+        case 1:
+            PINJ = state & 0x7F;
+            PINE = (PINE & ~0x01) | (state >> 7);
+            break;
+        default:
+            PINK = state;
+            break;
+    }
+}
+
+void simFirePCINT(uint8_t port)
+{
+    _simRunPinChangeISR(port);
+}
+
+uint32_t simInterruptCount(uint8_t port)
+{
+    return _simInterruptCounts[port];
+}
+
+void pinMode(uint8_t, uint8_t)
+{
+}
+
+void digitalWrite(uint8_t, uint8_t)
+{
+}
+
+int digitalRead(uint8_t pin)
+{
+    for(const _SimPin& simPin : _simPins)
+    {
+        if(simPin.pin == pin)
+        {
+            return (*simPin.inputRegister >> simPin.bit) & 1;
+        }
+    }
+    return LOW;
+}
+
+unsigned long micros()
+{
+    return (uint32_t)_simTime;
+}
+
+unsigned long millis()
+{
+    return (uint32_t)(_simTime / 1000);
+}
+
+void delay(unsigned long ms)
+{
+    simAdvanceMicros(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    simAdvanceMicros(us);
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+    size_t n = 0;
+    while(size-- > 0)
+    {
+        n += write(*buffer++);
+    }
+    return n;
+}
+
+size_t Print::print(const char* str)
+{
+    return write((const uint8_t*)str, strlen(str));
+}
+
+size_t Print::print(char c)
+{
+    return write((uint8_t)c);
+}
+
+size_t Print::print(long n)
+{
+    if(n < 0)
+    {
+        return print('-') + print((unsigned long)-n);
+    }
+    return print((unsigned long)n);
+}
+
+size_t Print::print(unsigned long n)
+{
+    char buffer[12];
+    char* str = &buffer[sizeof(buffer) - 1];
+    *str = '\0';
+    do
+    {
+        *--str = '0' + (n % 10);
+        n /= 10;
+    } while(n != 0);
+    return print(str);
+}
+
+size_t Print::println()
+{
+    return print("\r\n");
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    if(_length >= sizeof(_buffer))
+    {
+        return 0;
+    }
+    _buffer[_length++] = c;
+    return 1;
+}
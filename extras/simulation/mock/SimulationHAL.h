@@ -0,0 +1,31 @@
+#ifndef SIMULATION_HAL_H_
+#define SIMULATION_HAL_H_
+
+#include <Arduino.h>
+
+//Controls the simulated ATMega2560. All functions have to be called from the test code, never from inside an ISR.
+
+//Clears all registers, sets all pins to LOW and the time to 0.
+//Library state is not touched, so all RCReader instances should be destroyed before.
+void simReset();
+
+//Moves the time forward by the given number of microseconds. The hardware timers count with it and fire their overflow interrupts.
+void simAdvanceMicros(uint32_t microseconds);
+
+//Moves the time forward until micros() returns the given value. The time can only move forward, so this wraps around if needed.
+void simSetMicros(uint32_t microseconds);
+
+//Sets the level of an Arduino pin. If the level changed and the pin change interrupt of the pin is enabled, its ISR runs right away.
+void simSetPin(uint8_t pin, uint8_t level);
+
+//Sets all pins of a port (0-2) at once without running any ISR. The state has the layout the library uses for its ISRs:
+//PORTB for port 0, PORTJ with PE0 in bit 7 for port 1 and PORTK for port 2.
+void simSetPortState(uint8_t port, uint8_t state);
+
+//Runs the pin change ISR of a port (0-2) without changing any pin, like a spurious interrupt or a change that was too short to be seen.
+void simFirePCINT(uint8_t port);
+
+//Number of pin change ISR calls of a port since the last simReset
+uint32_t simInterruptCount(uint8_t port);
+
+#endif
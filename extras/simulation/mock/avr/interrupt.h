@@ -0,0 +1,24 @@
+#ifndef SIMULATION_AVR_INTERRUPT_H_
+#define SIMULATION_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+//Interrupt vectors become plain C functions with the avr-libc vector names, so SimulationHAL can call them.
+//Attributes like weak are applied to a declaration in front of the definition.
+#define ISR(vector, ...) extern "C" void vector(void) __VA_ARGS__; extern "C" void vector(void)
+
+//Vector numbers of the ATMega2560
+#define PCINT0_vect __vector_9
+#define PCINT1_vect __vector_10
+#define PCINT2_vect __vector_11
+#define TIMER1_OVF_vect __vector_20
+#define TIMER0_COMPA_vect __vector_21
+#define TIMER3_OVF_vect __vector_35
+#define TIMER4_OVF_vect __vector_45
+#define TIMER5_OVF_vect __vector_50
+
+//The global interrupt flag is bit 7 of SREG, like on the real chip
+#define cli() (SREG &= (uint8_t)~0x80)
+#define sei() (SREG |= 0x80)
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef SIMULATION_AVR_IO_H_
+#define SIMULATION_AVR_IO_H_
+
+#include <stdint.h>
+
+//Registers of the ATMega2560 that are used by the library. They are plain variables that are read and written by SimulationHAL.
+
+extern volatile uint8_t SREG;
+
+//Pin input registers
+extern volatile uint8_t PINB;
+extern volatile uint8_t PINE;
+extern volatile uint8_t PINJ;
+extern volatile uint8_t PINK;
+
+//Pin change interrupts
+extern volatile uint8_t PCICR;
+extern volatile uint8_t PCIFR;
+extern volatile uint8_t PCMSK0;
+extern volatile uint8_t PCMSK1;
+extern volatile uint8_t PCMSK2;
+
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+#define PCIF0 0
+#define PCIF1 1
+#define PCIF2 2
+
+//Timer0 is used by micros(). It counts with the prescaler of 64 that is set up by the Arduino core,
+//only its counter and the compare match A interrupt are simulated.
+extern volatile uint8_t TCNT0;
+extern volatile uint8_t OCR0A;
+extern volatile uint8_t TIMSK0;
+extern volatile uint8_t TIFR0;
+
+#define OCIE0A 1
+#define OCF0A 1
+
+//16 bit timers 1, 3, 4 and 5. Only the normal mode is simulated, the compare and input capture registers are plain variables.
+#define _SIM_TIMER16(n) \
+    extern volatile uint8_t TCCR##n##A; \
+    extern volatile uint8_t TCCR##n##B; \
+    extern volatile uint8_t TIMSK##n; \
+    extern volatile uint8_t TIFR##n; \
+    extern volatile uint16_t TCNT##n; \
+    extern volatile uint16_t ICR##n; \
+    extern volatile uint16_t OCR##n##A; \
+    extern volatile uint16_t OCR##n##B; \
+    extern volatile uint16_t OCR##n##C;
+
+_SIM_TIMER16(1)
+_SIM_TIMER16(3)
+_SIM_TIMER16(4)
+_SIM_TIMER16(5)
+
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define CS30 0
+#define CS31 1
+#define CS32 2
+#define CS40 0
+#define CS41 1
+#define CS42 2
+#define CS50 0
+#define CS51 1
+#define CS52 2
+#define TOIE1 0
+#define TOIE3 0
+#define TOIE4 0
+#define TOIE5 0
+#define TOV1 0
+#define TOV3 0
+#define TOV4 0
+#define TOV5 0
+
+//Waveform generation and compare output mode bits
+#define WGM10 0
+#define WGM11 1
+#define WGM12 3
+#define WGM13 4
+#define COM1C1 3
+#define COM1B1 5
+#define COM1A1 7
+#define WGM30 0
+#define WGM31 1
+#define WGM32 3
+#define WGM33 4
+#define COM3C1 3
+#define COM3B1 5
+#define COM3A1 7
+#define WGM40 0
+#define WGM41 1
+#define WGM42 3
+#define WGM43 4
+#define COM4C1 3
+#define COM4B1 5
+#define COM4A1 7
+#define WGM50 0
+#define WGM51 1
+#define WGM52 3
+#define WGM53 4
+#define COM5C1 3
+#define COM5B1 5
+#define COM5A1 7
+
+#endif
@@ -0,0 +1,56 @@
+#include "TestFramework.h"
+#include "SignalGenerator.h"
+#include "RCReaderSet.h"
+
+typedef RCReaderSet<RCR_PIN_A8, RCR_PIN_A9, RCR_PIN_50> Receiver;
+RCREADER_SET_ISRS(Receiver)
+
+TEST(setMeasuresAllChannels)
+{
+    const uint8_t pins[] = {RCR_PIN_A8, RCR_PIN_A9, RCR_PIN_50};
+    const uint16_t widths[] = {1100, 1500, 1900};
+    Receiver::begin();
+    CHECK_EQUAL(0x03, PCMSK2);
+    CHECK_EQUAL(0x08, PCMSK0);
+    SignalGenerator generator;
+    generator.addReceiver(pins, widths, 3);
+    generator.run(3 * 20000);
+    for(uint8_t i = 0; i < 3; i++)
+    {
+        CHECK_EQUAL(widths[i], Receiver::getMicroseconds(i));
+    }
+    uint16_t value;
+    CHECK_EQUAL(RCR_InitFailed, Receiver::getMicroseconds(3, &value));
+}
+
+TEST(setRangeAndTimeout)
+{
+    Receiver::begin();
+    Receiver::setValidRange(1000, 2000, true);
+    Receiver::setTimeout(30);
+    SignalGenerator generator;
+    uint8_t signal = generator.addPWM(RCR_PIN_A8, 1500, 20000, 100);
+    generator.run(20000);
+    uint16_t value;
+    CHECK_EQUAL(RCR_OK, Receiver::getMicroseconds(0, &value));
+    generator.setValue(signal, 2100);
+    generator.run(20000);
+    CHECK_EQUAL(RCR_InvalidValue, Receiver::getMicroseconds(0, &value));
+    CHECK_EQUAL(1500, value);
+    generator.stop(signal);
+    simAdvanceMicros(35000);
+    CHECK_EQUAL(RCR_Timeout, Receiver::getMicroseconds(0, &value));
+    Receiver::setValidRange(0, 0);
+    Receiver::setTimeout(0);
+}
+
+TEST(setChainsUnusedPortToRuntimeReaders)
+{
+    Receiver::begin();
+    //port 1 is not used by the set, so the generated ISR passes it on
+    RCReader reader(RCR_PIN_14);
+    SignalGenerator generator;
+    generator.addPWM(RCR_PIN_14, 1300, 20000, 100);
+    generator.run(2 * 20000);
+    CHECK_EQUAL(1300, reader.getMicroseconds());
+}
@@ -0,0 +1,901 @@
+#include "TestFramework.h"
+#include "SignalGenerator.h"
+#include "RCReader.h"
+#include <type_traits>
+
+//Pulses start 100us after a period starts, so running whole periods never stops right at an edge
+#define PERIOD 20000
+#define OFFSET 100
+
+//The pool slots point back to the instances, a copy would free them twice
+static_assert(!std::is_copy_constructible<RCReader>::value && !std::is_copy_assignable<RCReader>::value, "RCReader can be copied");
+static_assert(!std::is_copy_constructible<RCReaderPPM>::value && !std::is_copy_assignable<RCReaderPPM>::value, "RCReaderPPM can be copied");
+static_assert(!std::is_copy_constructible<RCReaderGroup>::value && !std::is_copy_assignable<RCReaderGroup>::value, "RCReaderGroup can be copied");
+
+TEST(measuresSinglePulse)
+{
+    RCReader reader(RCR_PIN_A8);
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    generator.addPWM(RCR_PIN_A8, 1500, PERIOD, OFFSET);
+    generator.run(3 * PERIOD);
+
+    uint16_t value = 0;
+    CHECK_EQUAL(RCR_OK, reader.getMicroseconds(&value));
+    CHECK_EQUAL(1500, value);
+    CHECK_EQUAL(1500, reader.getMicroseconds());
+}
+
+TEST(measuresPinsOfAllPorts)
+{
+    //includes pin 0 (PE0) that is mapped into the PORTJ state and both pins of PORTJ
+    const uint8_t pins[] = {RCR_PIN_53, RCR_PIN_13, RCR_PIN_0, RCR_PIN_15, RCR_PIN_14, RCR_PIN_A8, RCR_PIN_A15};
+    const uint16_t widths[] = {1000, 1100, 1200, 1300, 1400, 1500, 1600};
+    RCReader r0(RCR_PIN_53), r1(RCR_PIN_13), r2(RCR_PIN_0), r3(RCR_PIN_15), r4(RCR_PIN_14), r5(RCR_PIN_A8), r6(RCR_PIN_A15);
+    RCReader* readers[] = {&r0, &r1, &r2, &r3, &r4, &r5, &r6};
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    generator.addReceiver(pins, widths, 7);
+    generator.run(3 * PERIOD + 5000);
+
+    for(uint8_t i = 0; i < 7; i++)
+    {
+        CHECK_EQUAL(widths[i], readers[i]->getMicroseconds());
+    }
+    CHECK_EQUAL(PCMSK0, (1 << 0) | (1 << 7));
+    CHECK_EQUAL(PCMSK1, (1 << 0) | (1 << 1) | (1 << 2));
+    CHECK_EQUAL(PCMSK2, (1 << 0) | (1 << 7));
+}
+
+TEST(simultaneousEdgesOnOnePort)
+{
+    RCReader a(RCR_PIN_A8), b(RCR_PIN_A9);
+    //both pins change with one interrupt, like when they are connected to the same signal
+    PINK |= 0x02;
+    simSetPin(RCR_PIN_A8, HIGH);
+    simAdvanceMicros(1200);
+    PINK &= ~0x02;
+    simSetPin(RCR_PIN_A8, LOW);
+    RCReader::poll();
+    CHECK_EQUAL(1200, a.getMicroseconds());
+    CHECK_EQUAL(1200, b.getMicroseconds());
+}
+
+TEST(pulseAcrossMicrosOverflow)
+{
+    simSetMicros(0xFFFFFFFF - 700);
+    RCReader reader(RCR_PIN_A8);
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    generator.addPWM(RCR_PIN_A8, 1500);
+    generator.run(1600);
+    CHECK(micros() < 1000); //the pulse ended after the overflow
+    CHECK_EQUAL(1500, reader.getMicroseconds());
+}
+
+TEST(ignoresSpuriousInterrupts)
+{
+    RCReader reader(RCR_PIN_A8);
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    generator.addPWM(RCR_PIN_A8, 1500, PERIOD, OFFSET);
+    generator.run(PERIOD);
+    CHECK_EQUAL(1500, reader.getMicroseconds());
+
+    simFirePCINT(2);
+    simAdvanceMicros(500);
+    simFirePCINT(2);
+    RCReader::poll();
+    CHECK(!reader.hasNewValue());
+    CHECK_EQUAL(1500, reader.getMicroseconds());
+}
+
+TEST(timeout)
+{
+    RCReader reader(RCR_PIN_A8, 50);
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    uint8_t signal = generator.addPWM(RCR_PIN_A8, 1500, PERIOD, 0);
+    //stop right after the falling edge, the last rising edge was 1501us ago
+    generator.run(5 * PERIOD + 1501);
+    generator.stop(signal);
+
+    uint16_t value;
+    simAdvanceMicros(48000);
+    CHECK_EQUAL(RCR_OK, reader.getMicroseconds(&value));
+    simAdvanceMicros(2000);
+    CHECK_EQUAL(RCR_Timeout, reader.getMicroseconds(&value));
+    CHECK_EQUAL(1500, value); //the last value is still passed on
+    CHECK_EQUAL(-1, reader.getMicroseconds());
+
+    //the signal comes back
+    reader.setTimeout(0);
+    CHECK_EQUAL(RCR_OK, reader.getMicroseconds(&value));
+}
+
+TEST(timeoutAcrossMicrosOverflow)
+{
+    simSetMicros(0xFFFFFFFF - 10000);
+    RCReader reader(RCR_PIN_A8, 20);
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    uint8_t signal = generator.addPWM(RCR_PIN_A8, 1500, PERIOD, 0);
+    generator.run(1501);
+    generator.stop(signal);
+
+    uint16_t value;
+    simAdvanceMicros(18000); //micros() overflowed, 19.5ms passed
+    CHECK(micros() < 10000);
+    CHECK_EQUAL(RCR_OK, reader.getMicroseconds(&value));
+    simAdvanceMicros(2000);
+    CHECK_EQUAL(RCR_Timeout, reader.getMicroseconds(&value));
+}
+
+TEST(failsafe)
+{
+    RCReader reader(RCR_PIN_A8);
+    reader.setFailsafe(30, 1000, 2);
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    uint8_t signal = generator.addPWM(RCR_PIN_A8, 1500, PERIOD, 0);
+    generator.run(5 * PERIOD + 1501);
+    generator.stop(signal);
+
+    //the failsafe is activated by the tick interrupt, the reader is not read in the meantime
+    simAdvanceMicros(27000);
+    CHECK(!reader.isFailsafe());
+    simAdvanceMicros(4000);
+    CHECK(reader.isFailsafe());
+    uint16_t value;
+    CHECK_EQUAL(RCR_Timeout, reader.getMicroseconds(&value));
+    CHECK_EQUAL(1000, value);
+    CHECK_EQUAL(1000, reader.getMicroseconds());
+
+    //the signal comes back, the failsafe is left after the second complete pulse
+    generator.addPWM(RCR_PIN_A8, 1600, PERIOD, 0);
+    generator.run(1601);
+    CHECK(reader.isFailsafe());
+    CHECK_EQUAL(RCR_Timeout, reader.getMicroseconds(&value));
+    generator.run(PERIOD);
+    CHECK(!reader.isFailsafe());
+    CHECK_EQUAL(RCR_OK, reader.getMicroseconds(&value));
+    CHECK_EQUAL(1600, value);
+}
+
+TEST(validRange)
+{
+    RCReader reader(RCR_PIN_A8, 0, 1000, 2000);
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    uint8_t signal = generator.addPWM(RCR_PIN_A8, 1500, PERIOD, OFFSET);
+    generator.run(PERIOD);
+
+    uint16_t value;
+    CHECK_EQUAL(RCR_OK, reader.getMicroseconds(&value));
+    generator.setValue(signal, 2500);
+    generator.run(PERIOD);
+    CHECK_EQUAL(RCR_InvalidValue, reader.getMicroseconds(&value));
+    CHECK_EQUAL(2500, value);
+    CHECK_EQUAL(-1, reader.getMicroseconds());
+
+    //holding the last valid value
+    reader.setValidRange(1000, 2000, true);
+    CHECK_EQUAL(RCR_InvalidValue, reader.getMicroseconds(&value));
+    CHECK_EQUAL(1500, value);
+    CHECK_EQUAL(1500, reader.getMicroseconds());
+
+    //a range of 0 to 0 disables the check
+    reader.setValidRange(0, 0);
+    CHECK_EQUAL(RCR_OK, reader.getMicroseconds(&value));
+    CHECK_EQUAL(2500, value);
+}
+
+TEST(invalidPin)
+{
+    RCReader reader((RCReaderPin)2);
+    uint16_t value;
+    CHECK_EQUAL(RCR_InitFailed, reader.getMicroseconds(&value));
+    CHECK_EQUAL(-1, reader.getMicroseconds());
+    CHECK_EQUAL(0, PCICR);
+}
+
+TEST(readersShareOnePin)
+{
+    RCReader* wide = new RCReader(RCR_PIN_A8);
+    RCReader narrow(RCR_PIN_A8, 0, 1000, 1400);
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    generator.addPWM(RCR_PIN_A8, 1500, PERIOD, OFFSET);
+    generator.run(PERIOD);
+
+    uint16_t value;
+    CHECK_EQUAL(RCR_OK, wide->getMicroseconds(&value));
+    CHECK_EQUAL(RCR_InvalidValue, narrow.getMicroseconds(&value));
+    CHECK_EQUAL(1500, value);
+
+    //the pin stays enabled as long as one reader uses it
+    delete wide;
+    CHECK_EQUAL(0x01, PCMSK2);
+    generator.run(PERIOD);
+    CHECK(narrow.hasNewValue());
+}
+
+TEST(detachDisablesPinChangeInterrupt)
+{
+    {
+        RCReader a(RCR_PIN_A8), b(RCR_PIN_A9), c(RCR_PIN_53);
+        CHECK_EQUAL(0x03, PCMSK2);
+        CHECK_EQUAL((1 << PCIE0) | (1 << PCIE2), PCICR);
+    }
+    CHECK_EQUAL(0, PCMSK2);
+    CHECK_EQUAL(0, PCMSK0);
+    CHECK_EQUAL(0, PCICR);
+}
+
+TEST(poolExhaustion)
+{
+    const RCReaderPin pins[] = {RCR_PIN_53, RCR_PIN_52, RCR_PIN_51, RCR_PIN_50, RCR_PIN_10, RCR_PIN_11, RCR_PIN_12, RCR_PIN_13, RCR_PIN_0,
+                                RCR_PIN_14, RCR_PIN_15, RCR_PIN_A8, RCR_PIN_A9, RCR_PIN_A10, RCR_PIN_A11, RCR_PIN_A12, RCR_PIN_A13, RCR_PIN_A14, RCR_PIN_A15};
+    RCReader* readers[19];
+    for(uint8_t i = 0; i < 19; i++)
+    {
+        readers[i] = new RCReader(pins[i]);
+    }
+    uint16_t value;
+    CHECK_EQUAL(RCR_OK, readers[17]->getMicroseconds(&value));
+    CHECK_EQUAL(RCR_InitFailed, readers[18]->getMicroseconds(&value));
+
+    //a freed slot can be used again
+    delete readers[18];
+    delete readers[3];
+    readers[18] = new RCReader(RCR_PIN_A15);
+    CHECK_EQUAL(RCR_OK, readers[18]->getMicroseconds(&value));
+    for(uint8_t i = 0; i < 19; i++)
+    {
+        if(i != 3)
+        {
+            delete readers[i];
+        }
+    }
+    CHECK_EQUAL(0, PCICR);
+}
+
+TEST(hasNewValue)
+{
+    RCReader reader(RCR_PIN_A8);
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    generator.addPWM(RCR_PIN_A8, 1500, PERIOD, OFFSET);
+    CHECK(!reader.hasNewValue());
+    generator.run(PERIOD);
+    CHECK(reader.hasNewValue());
+    reader.getMicroseconds();
+    CHECK(!reader.hasNewValue());
+}
+
+#ifdef RCREADER_ENABLE_CALIBRATION
+//Sends a few pulses of the given width and returns the normalized value, -32768 if the status is not RCR_OK
+static int16_t normalizedPulse(RCReader& reader, SignalGenerator& generator, uint8_t signal, uint16_t pulseWidth)
+{
+    generator.setValue(signal, pulseWidth);
+    generator.run(2 * PERIOD);
+    int16_t value = 0;
+    return (reader.getNormalized(&value) == RCR_OK) ? value : -32768;
+}
+
+TEST(calibration)
+{
+    RCReader reader(RCR_PIN_A8);
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+
+    //no pulse was measured yet, the stick is not at its end point
+    int16_t normalized = 1234;
+    CHECK_EQUAL(RCR_InvalidValue, reader.getNormalized(&normalized));
+    CHECK_EQUAL(0, normalized);
+
+    uint8_t signal = generator.addPWM(RCR_PIN_A8, 1500, PERIOD, OFFSET);
+
+    //default calibration 1000, 1500, 2000
+    CHECK_EQUAL(0, normalizedPulse(reader, generator, signal, 1500));
+    CHECK_EQUAL(-1000, normalizedPulse(reader, generator, signal, 1000));
+    CHECK_EQUAL(1000, normalizedPulse(reader, generator, signal, 2000));
+    CHECK_EQUAL(500, normalizedPulse(reader, generator, signal, 1750));
+    CHECK_EQUAL(1000, normalizedPulse(reader, generator, signal, 2100)); //limited to the end point
+
+    //asymmetric end points with deadband
+    reader.setCalibration(1100, 1520, 1900, 20);
+    CHECK_EQUAL(0, normalizedPulse(reader, generator, signal, 1530));
+    CHECK_EQUAL(0, normalizedPulse(reader, generator, signal, 1500));
+    CHECK_EQUAL(500, normalizedPulse(reader, generator, signal, 1720));
+    CHECK_EQUAL(1000, normalizedPulse(reader, generator, signal, 1900));
+    CHECK_EQUAL(-1000, normalizedPulse(reader, generator, signal, 1100));
+
+    //full expo is the cubic curve
+    reader.setCalibration(1000, 1500, 2000, 0, 100);
+    CHECK_EQUAL(125, normalizedPulse(reader, generator, signal, 1750));
+    CHECK_EQUAL(-125, normalizedPulse(reader, generator, signal, 1250));
+    CHECK_EQUAL(1000, normalizedPulse(reader, generator, signal, 2000));
+
+    //invalid calibrations are ignored
+    reader.setCalibration(1500, 1500, 2000);
+    CHECK_EQUAL(125, normalizedPulse(reader, generator, signal, 1750));
+
+    //a reader that could not be attached passes the center
+    RCReader invalid((RCReaderPin)2);
+    int16_t value = 1234;
+    CHECK_EQUAL(RCR_InitFailed, invalid.getNormalized(&value));
+    CHECK_EQUAL(0, value);
+}
+#endif
+
+TEST(ppm)
+{
+    const uint16_t values[] = {1000, 1100, 1200, 1300, 1400, 1500, 1600, 1700};
+    RCReaderPPM ppm(RCR_PIN_A9);
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    generator.addPPM(RCR_PIN_A9, values, 8);
+    CHECK_EQUAL(0, ppm.getChannelCount());
+    generator.run(3 * 22500 + 1000);
+
+    CHECK_EQUAL(8, ppm.getChannelCount());
+    CHECK(ppm.getFrameCounter() >= 2);
+    for(uint8_t i = 0; i < 8; i++)
+    {
+        CHECK_EQUAL(values[i], ppm.getMicroseconds(i));
+    }
+    uint16_t value;
+    CHECK_EQUAL(RCR_InvalidValue, ppm.getMicroseconds(8, &value));
+    CHECK_EQUAL(RCR_InitFailed, ppm.getMicroseconds(RCREADER_PPM_MAX_CHANNELS, &value));
+
+    //a PPM signal can not be shared with a PWM reader
+    RCReader reader(RCR_PIN_A9);
+    CHECK_EQUAL(RCR_InitFailed, reader.getMicroseconds(&value));
+}
+
+#ifdef RCREADER_ENABLE_FILTERS
+TEST(medianFilter)
+{
+    RCReader reader(RCR_PIN_A8);
+    reader.setFilter(RCR_FILTER_MEDIAN3);
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    uint8_t signal = generator.addPWM(RCR_PIN_A8, 1500, PERIOD, OFFSET);
+    generator.run(3 * PERIOD);
+    generator.setValue(signal, 2500);
+    generator.run(PERIOD);
+    CHECK_EQUAL(1500, reader.getMicroseconds());
+    generator.run(PERIOD);
+    CHECK_EQUAL(2500, reader.getMicroseconds());
+
+    //without a filter every pulse is passed on right away
+    reader.setFilter(RCR_FILTER_NONE);
+    generator.setValue(signal, 1200);
+    generator.run(PERIOD);
+    CHECK_EQUAL(1200, reader.getMicroseconds());
+}
+
+TEST(spikeFilter)
+{
+    RCReader reader(RCR_PIN_A8);
+    reader.setFilter(RCR_FILTER_NONE, 200);
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    uint8_t signal = generator.addPWM(RCR_PIN_A8, 1500, PERIOD, OFFSET);
+    generator.run(PERIOD);
+    reader.getMicroseconds();
+
+    //a single spike is dropped and does not count as new value
+    generator.setValue(signal, 1900);
+    generator.run(PERIOD);
+    CHECK(!reader.hasNewValue());
+    CHECK_EQUAL(1500, reader.getMicroseconds());
+    //a second one in a row is a real change
+    generator.run(PERIOD);
+    CHECK_EQUAL(1900, reader.getMicroseconds());
+}
+#endif
+
+static uint16_t _frameCallbackCount;
+
+static void _countFrame()
+{
+    _frameCallbackCount++;
+}
+
+TEST(group)
+{
+    const uint8_t pins[] = {RCR_PIN_A8, RCR_PIN_A9, RCR_PIN_A10};
+    const uint16_t widths[] = {1000, 1500, 2000};
+    RCReader a(RCR_PIN_A8), b(RCR_PIN_A9), c(RCR_PIN_A10, 0, 1000, 1900);
+    RCReaderGroup group;
+    CHECK(group.add(a));
+    CHECK(group.add(b));
+    CHECK(group.add(c));
+    CHECK_EQUAL(3, group.getChannelCount());
+
+    _frameCallbackCount = 0;
+    group.setFrameCallback(_countFrame);
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    uint8_t receiver = generator.addReceiver(pins, widths, 3);
+    generator.run(5 * PERIOD - 1);
+    CHECK_EQUAL(5, _frameCallbackCount);
+    CHECK_EQUAL(0x07, group.changedMask());
+
+    uint16_t values[3];
+    RCRStatus status[3];
+    uint16_t pulseCount = group.snapshot(values, status, 3);
+    CHECK_EQUAL(15, pulseCount);
+    CHECK_EQUAL(1000, values[0]);
+    CHECK_EQUAL(1500, values[1]);
+    CHECK_EQUAL(2000, values[2]);
+    CHECK_EQUAL(RCR_OK, status[0]);
+    CHECK_EQUAL(RCR_InvalidValue, status[2]);
+    CHECK_EQUAL(0, group.changedMask());
+    CHECK_EQUAL(pulseCount, group.snapshot(values, status, 3));
+
+    //pulses of readers outside of the group do not change the pulse count
+    for(uint8_t i = 0; i < 3; i++)
+    {
+        generator.stop(receiver + i); //every channel of the receiver is its own signal
+    }
+    RCReader outside(RCR_PIN_A11);
+    generator.addPWM(RCR_PIN_A11, 1500, PERIOD, OFFSET);
+    generator.run(2 * PERIOD);
+    CHECK_EQUAL(1500, outside.getMicroseconds());
+    CHECK_EQUAL(pulseCount, group.snapshot(values, status, 3));
+
+    group.setFrameCallback(NULL);
+}
+
+TEST(frameCallbackEndsWithItsReaders)
+{
+    RCReader other(RCR_PIN_A8);
+    _frameCallbackCount = 0;
+    {
+        RCReader reader(RCR_PIN_A9);
+        RCReaderGroup group;
+        group.add(reader);
+        group.setFrameCallback(_countFrame);
+    }
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    generator.addPWM(RCR_PIN_A8, 1500, PERIOD, OFFSET);
+    generator.run(3 * PERIOD);
+    CHECK_EQUAL(1500, other.getMicroseconds());
+    CHECK_EQUAL(0, _frameCallbackCount);
+}
+
+TEST(frameCallbackEndsWithItsGroup)
+{
+    RCReader reader(RCR_PIN_A8);
+    RCReaderGroup keeper;
+    keeper.add(reader);
+    _frameCallbackCount = 0;
+    {
+        RCReaderGroup group;
+        group.add(reader);
+        group.setFrameCallback(_countFrame);
+    }
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    generator.addPWM(RCR_PIN_A8, 1500, PERIOD, OFFSET);
+    generator.run(3 * PERIOD);
+    CHECK_EQUAL(0, _frameCallbackCount);
+
+    //a group that did not register the callback leaves it alone
+    keeper.setFrameCallback(_countFrame);
+    {
+        RCReaderGroup other;
+        other.add(reader);
+    }
+    generator.run(3 * PERIOD);
+    CHECK_EQUAL(3, _frameCallbackCount);
+    keeper.setFrameCallback(NULL);
+}
+
+TEST(groupReadAll)
+{
+    const uint8_t pins[] = {RCR_PIN_A8, RCR_PIN_A9, RCR_PIN_50};
+    const uint16_t widths[] = {1000, 1500, 2000};
+    RCReaderGroup group;
+    CHECK(group.addChannel(RCR_PIN_A8, 30));
+    CHECK(group.addChannel(RCR_PIN_A9, 30, 1000, 1400, true));
+    CHECK(group.addChannel(RCR_PIN_50, 30));
+    {
+        //the group keeps the measurement of a RCReader alive after the reader is gone
+        RCReader reader(RCR_PIN_A10, 30);
+        CHECK(group.add(reader));
+    }
+    CHECK(group.addChannel((RCReaderPin)7));
+    CHECK_EQUAL(5, group.getChannelCount());
+
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    generator.addReceiver(pins, widths, 3);
+    uint8_t signal = generator.addPWM(RCR_PIN_A10, 1800, PERIOD, 10000);
+    generator.run(3 * PERIOD);
+    CHECK_EQUAL(0x0F, group.changedMask());
+
+    uint16_t values[5] = {0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF};
+    uint32_t errors = 0;
+    uint32_t timeouts = 0;
+    group.readAll(values, &errors, &timeouts);
+    CHECK_EQUAL(1000, values[0]);
+    CHECK_EQUAL(0, values[1]); //out of range without a valid value to hold yet
+    CHECK_EQUAL(2000, values[2]);
+    CHECK_EQUAL(1800, values[3]);
+    CHECK_EQUAL(0, values[4]); //the pin can not be used
+    CHECK_EQUAL(0x12, errors); //invalid range and invalid pin
+    CHECK_EQUAL(0, timeouts);
+    CHECK_EQUAL(0, group.changedMask());
+
+    generator.stop(signal);
+    generator.run(2 * PERIOD);
+    group.readAll(values, &errors);
+    CHECK_EQUAL(0x1A, errors);
+    group.readAll(values, &errors, &timeouts);
+    CHECK_EQUAL(0x08, timeouts);
+    CHECK_EQUAL(1800, values[3]);
+}
+
+#if RCREADER_TIMESTAMP_TIMER != 0
+TEST(timestampTimerIsRestored)
+{
+    RCReader reader(RCR_PIN_A8);
+    //Arduino's init() changes the timer configuration after the global constructors ran
+    TCCR5B = 0x03;
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    generator.addPWM(RCR_PIN_A8, 1234, PERIOD, OFFSET);
+    generator.run(2 * PERIOD);
+    CHECK_EQUAL(1 << CS51, TCCR5B);
+    CHECK_EQUAL(1234, reader.getMicroseconds());
+}
+#endif
+
+#if RCREADER_OUTPUT_TIMER == 3
+TEST(outputFollowsPulses)
+{
+    RCReader reader(RCR_PIN_A8);
+    RCReaderOutput output(RCR_OUTPUT_A);
+    CHECK_EQUAL(RCR_OK, output.addInput(reader));
+    CHECK_EQUAL(39999, ICR3);
+    CHECK_EQUAL(1 << COM3A1 | 1 << WGM31, TCCR3A);
+    CHECK_EQUAL(1500, output.readMicroseconds()); //center until the first pulse
+
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    uint8_t signal = generator.addPWM(RCR_PIN_A8, 1600, PERIOD, OFFSET);
+    generator.run(OFFSET + 1601);
+    CHECK_EQUAL(3200, OCR3A); //updated by the pin change ISR, no read in between
+    generator.setValue(signal, 2300);
+    generator.run(2 * PERIOD);
+    CHECK_EQUAL(2000, output.readMicroseconds()); //limited to the maximum
+
+    //a second output on the same channel is not valid
+    RCReaderOutput duplicate(RCR_OUTPUT_A);
+    CHECK_EQUAL(RCR_InitFailed, duplicate.addInput(reader));
+}
+
+TEST(outputMixer)
+{
+    RCReader aileron(RCR_PIN_A8);
+    RCReader elevator(RCR_PIN_A9);
+    RCReaderOutput left(RCR_OUTPUT_B, 900, 2100);
+    RCReaderOutput right(RCR_OUTPUT_C, 900, 2100);
+    left.addInput(aileron, 64);
+    left.addInput(elevator, 64);
+    right.addInput(aileron, -64);
+    right.addInput(elevator, 64);
+    CHECK_EQUAL(RCR_InitFailed, right.addInput(elevator)); //only RCREADER_OUTPUT_INPUTS inputs
+
+    const uint8_t pins[] = {RCR_PIN_A8, RCR_PIN_A9};
+    const uint16_t widths[] = {1700, 1400};
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    generator.addReceiver(pins, widths, 2, PERIOD);
+    generator.run(2 * PERIOD);
+    CHECK_EQUAL(1500 + 100 - 50, left.readMicroseconds());
+    CHECK_EQUAL(1500 - 100 - 50, right.readMicroseconds());
+
+    left.clearInputs();
+    left.writeMicroseconds(1234);
+    generator.run(PERIOD);
+    CHECK_EQUAL(1234, left.readMicroseconds());
+}
+
+TEST(outputFailsafe)
+{
+    RCReader reader(RCR_PIN_A8);
+    reader.setFailsafe(30, 1100);
+    RCReaderOutput output(RCR_OUTPUT_A);
+    output.addInput(reader);
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    uint8_t signal = generator.addPWM(RCR_PIN_A8, 1800, PERIOD, 0);
+    generator.run(2 * PERIOD + 1801);
+    generator.stop(signal);
+    CHECK_EQUAL(1800, output.readMicroseconds());
+
+    //Arduino's init() changes the timer configuration after the global constructors ran, the tick restores it
+    TCCR3A = 0x01;
+    TCCR3B = 0x03;
+    simAdvanceMicros(31000);
+    CHECK_EQUAL(1 << COM3A1 | 1 << WGM31, TCCR3A);
+    CHECK_EQUAL(1 << WGM33 | 1 << WGM32 | 1 << CS31, TCCR3B);
+    CHECK_EQUAL(1100, output.readMicroseconds()); //moved by the tick interrupt
+}
+#endif
+
+#if RCREADER_OUTPUT_TIMER == 1
+TEST(outputPinsAreNoInputs)
+{
+    //pin 11 is compare output A of timer 1 and a pin change interrupt pin
+    RCReader input(RCR_PIN_11);
+    RCReaderOutput blocked(RCR_OUTPUT_A);
+    CHECK_EQUAL(RCR_InitFailed, blocked.addInput(input));
+    CHECK_EQUAL(0, TCCR1A & (1 << COM1A1));
+
+    //pin 12 is compare output B
+    RCReaderOutput output(RCR_OUTPUT_B);
+    RCReader reader(RCR_PIN_12);
+    uint16_t value;
+    CHECK_EQUAL(RCR_InitFailed, reader.getMicroseconds(&value));
+    CHECK_EQUAL(0, PCMSK0 & (1 << 6));
+    CHECK_EQUAL(RCR_OK, output.addInput(input));
+
+    //pin 13 is compare output C
+    RCReaderOutput third(RCR_OUTPUT_C);
+    RCReader onThird(RCR_PIN_13);
+    CHECK_EQUAL(RCR_InitFailed, onThird.getMicroseconds(&value));
+    CHECK_EQUAL(0, PCMSK0 & (1 << 7));
+    CHECK_EQUAL(RCR_OK, third.addInput(input));
+}
+#endif
+
+#ifdef RCREADER_DEFERRED_DECODE
+TEST(deferredDecodeWaitsForPoll)
+{
+    RCReader reader(RCR_PIN_A8);
+    SignalGenerator generator;
+    generator.addPWM(RCR_PIN_A8, 1500, PERIOD, OFFSET);
+    generator.run(PERIOD);
+    CHECK(!reader.hasNewValue());
+    CHECK_EQUAL(RCR_OK, RCReader::poll());
+    CHECK_EQUAL(1500, reader.getMicroseconds());
+}
+
+TEST(deferredDecodeQueueOverflow)
+{
+    RCReader reader(RCR_PIN_A8);
+    SignalGenerator generator;
+    uint8_t signal = generator.addPWM(RCR_PIN_A8, 1500, 2000, OFFSET);
+    //more edges than the queue can hold
+    generator.run(RCREADER_EDGE_QUEUE_SIZE * 1000 + 500);
+    CHECK_EQUAL(RCR_QueueOverflow, RCReader::poll());
+    CHECK_EQUAL(1500, reader.getMicroseconds());
+    //the overflow is only reported once, not again with the next queued pin change
+    generator.run(1000);
+    CHECK_EQUAL(RCR_OK, RCReader::poll());
+
+    //the measurement continues with the next complete pulse
+    generator.setValue(signal, 1200);
+    generator.setEdgeHook(testEdgeHook);
+    generator.run(4000);
+    CHECK_EQUAL(RCR_OK, RCReader::poll());
+    CHECK_EQUAL(1200, reader.getMicroseconds());
+}
+
+TEST(deferredDecodeQueueOverflowResyncsPort)
+{
+    RCReader reader(RCR_PIN_A8);
+    RCReader busy(RCR_PIN_A9);
+    SignalGenerator generator;
+    generator.addPWM(RCR_PIN_A9, 500, 1000, 0);
+    generator.addPWM(RCR_PIN_A8, 1500, PERIOD, 17000);
+    //A9 fills the queue, the rising edge of A8 at 17ms is dropped
+    generator.run(17500);
+    CHECK_EQUAL(RCR_QueueOverflow, RCReader::poll());
+
+    //the falling edge of A8 must not end a pulse that started with the next queued pin change of A9
+    generator.setEdgeHook(testEdgeHook);
+    generator.run(1500);
+    CHECK(!reader.hasNewValue());
+
+    //the first complete pulse after the gap is measured
+    generator.run(PERIOD);
+    uint16_t value;
+    CHECK_EQUAL(RCR_OK, reader.getMicroseconds(&value));
+    CHECK_EQUAL(1500, value);
+    CHECK_EQUAL(500, busy.getMicroseconds());
+}
+#endif
+
+#ifdef RCREADER_ENABLE_TRACE
+//Reads a little endian value of the dumped trace
+static uint16_t _traceValue(const uint8_t* data)
+{
+    return data[0] | (data[1] << 8);
+}
+
+TEST(traceRecordsPinChanges)
+{
+    RCReader reader(RCR_PIN_A8);
+    RCReader::startTrace();
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    uint8_t signal = generator.addPWM(RCR_PIN_A8, 1500, PERIOD, OFFSET);
+    generator.run(PERIOD);
+    generator.stop(signal);
+    //a pause that does not fit into the 16 bit delta of a record
+    simAdvanceMicros(100000);
+    simSetPin(RCR_PIN_A8, HIGH);
+    CHECK_EQUAL(4, RCReader::getTraceLength());
+
+    Serial.clearOutput();
+    RCReader::dumpTrace(Serial);
+    const uint8_t* trace = Serial.output();
+    CHECK_EQUAL(16 + 4 * 4, Serial.outputLength());
+    CHECK(memcmp(trace, "RCRT", 4) == 0);
+    CHECK_EQUAL(1, trace[4]);
+    CHECK_EQUAL(RCR_TICKS_PER_MICROSECOND, trace[5]);
+    CHECK_EQUAL(0, trace[6]);
+    CHECK_EQUAL(4, _traceValue(&trace[8]));
+    CHECK_EQUAL(0, _traceValue(&trace[10]));
+    CHECK_EQUAL(0, trace[14]); //port 2 was low when the recording started
+
+    const uint8_t* record = &trace[16];
+    CHECK_EQUAL(OFFSET * RCR_TICKS_PER_MICROSECOND, _traceValue(record));
+    CHECK_EQUAL(2, record[2]);
+    CHECK_EQUAL(0x01, record[3]);
+    record += 4;
+    CHECK_EQUAL(1500 * RCR_TICKS_PER_MICROSECOND, _traceValue(record));
+    CHECK_EQUAL(0x00, record[3]);
+    //pause record followed by the rising edge
+    uint32_t pause = (uint32_t)(PERIOD - OFFSET - 1500 + 100000) * RCR_TICKS_PER_MICROSECOND;
+    record += 4;
+    CHECK_EQUAL(0x0F, record[2]);
+    CHECK_EQUAL(pause >> 16, _traceValue(record));
+    record += 4;
+    CHECK_EQUAL(pause & 0xFFFF, _traceValue(record));
+    CHECK_EQUAL(0x01, record[3]);
+
+    //dumping stops the recording
+    simSetPin(RCR_PIN_A8, LOW);
+    CHECK_EQUAL(4, RCReader::getTraceLength());
+}
+
+TEST(traceStopsWhenFull)
+{
+    RCReader reader(RCR_PIN_A8);
+    RCReader::startTrace();
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    generator.addPWM(RCR_PIN_A8, 1500, 2000, OFFSET);
+    generator.run(RCREADER_TRACE_SIZE * 1000 + 10000);
+    CHECK_EQUAL(RCREADER_TRACE_SIZE, RCReader::getTraceLength());
+
+    Serial.clearOutput();
+    RCReader::dumpTrace(Serial);
+    const uint8_t* trace = Serial.output();
+    CHECK_EQUAL(0, trace[6]);
+    CHECK_EQUAL(10, _traceValue(&trace[10]));
+    //the first record is the first rising edge
+    CHECK_EQUAL(OFFSET * RCR_TICKS_PER_MICROSECOND, _traceValue(&trace[16]));
+    CHECK_EQUAL(1500, reader.getMicroseconds()); //recording does not change the measurement
+}
+
+TEST(traceContinuousKeepsLatest)
+{
+    RCReader reader(RCR_PIN_A8);
+    RCReader::startTrace(true);
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    generator.addPWM(RCR_PIN_A8, 1500, 2000, OFFSET);
+    generator.run(RCREADER_TRACE_SIZE * 1000 + 10000);
+    CHECK_EQUAL(RCREADER_TRACE_SIZE, RCReader::getTraceLength());
+
+    Serial.clearOutput();
+    RCReader::dumpTrace(Serial);
+    const uint8_t* trace = Serial.output();
+    CHECK_EQUAL(0x03, trace[6]);
+    CHECK_EQUAL(0, _traceValue(&trace[10]));
+    //the last generated edge is the falling edge of the last pulse
+    const uint8_t* last = &trace[16 + (RCREADER_TRACE_SIZE - 1) * 4];
+    CHECK_EQUAL(1500 * RCR_TICKS_PER_MICROSECOND, _traceValue(last));
+    CHECK_EQUAL(0x00, last[3]);
+}
+#endif
+
+#ifdef RCREADER_ENABLE_STATS
+TEST(statsCountPulses)
+{
+    RCReader reader(RCR_PIN_A8);
+    RCRPortStats portStats;
+    RCReader::getPortStats(2, &portStats, true); //the port counters are kept over the lifetime of the readers
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    generator.addPWM(RCR_PIN_A8, 1500, PERIOD, OFFSET);
+    generator.setJitter(5);
+    generator.run(10 * PERIOD);
+
+    RCRReaderStats stats;
+    CHECK_EQUAL(RCR_OK, reader.getStats(&stats));
+    CHECK_EQUAL(20, stats.edgeCount);
+    CHECK(stats.minimumWidth >= 1495 && stats.minimumWidth < stats.maximumWidth && stats.maximumWidth <= 1505);
+    CHECK_EQUAL(stats.maximumWidth - stats.minimumWidth, stats.jitter);
+    CHECK(stats.framePeriod >= PERIOD - 10 && stats.framePeriod <= PERIOD + 10);
+    CHECK_EQUAL(50, stats.frameRate);
+    CHECK_EQUAL(0, stats.impossibleTransitions);
+
+    CHECK_EQUAL(RCR_OK, RCReader::getPortStats(2, &portStats, true));
+    CHECK_EQUAL(20, portStats.isrCount);
+    CHECK_EQUAL(0, portStats.missedEdges);
+    CHECK_EQUAL(RCR_OK, RCReader::getPortStats(2, &portStats));
+    CHECK_EQUAL(0, portStats.isrCount);
+    CHECK_EQUAL(RCR_InitFailed, RCReader::getPortStats(3, &portStats));
+
+    reader.getStats(&stats, true);
+    reader.getStats(&stats);
+    CHECK_EQUAL(0, stats.edgeCount);
+    CHECK_EQUAL(0, stats.minimumWidth);
+}
+
+TEST(statsMissedEdges)
+{
+    RCReader reader(RCR_PIN_A8);
+    RCRPortStats portStats;
+    RCReader::getPortStats(2, &portStats, true);
+    //the pin toggled twice before the ISR could read it, so the interrupt finds no changed pin
+    simFirePCINT(2);
+    simFirePCINT(2);
+    RCReader::poll();
+    RCReader::getPortStats(2, &portStats);
+    CHECK_EQUAL(2, portStats.isrCount);
+    CHECK_EQUAL(2, portStats.missedEdges);
+}
+
+TEST(statsDoubleToggle)
+{
+    RCReader reader(RCR_PIN_A8);
+    SignalGenerator generator;
+    generator.setEdgeHook(testEdgeHook);
+    generator.addPWM(RCR_PIN_A8, 1500, PERIOD, OFFSET);
+    generator.run(2 * PERIOD);
+    //the pin toggled twice before the ISR could read it, with a single reader on the port it is counted for that reader
+    simFirePCINT(2);
+    RCReader::poll();
+    RCRReaderStats stats;
+    reader.getStats(&stats);
+    CHECK_EQUAL(1, stats.impossibleTransitions);
+
+    //with two readers on the port it is not clear which pin it was
+    RCReader other(RCR_PIN_A9);
+    simFirePCINT(2);
+    RCReader::poll();
+    reader.getStats(&stats);
+    CHECK_EQUAL(1, stats.impossibleTransitions);
+}
+
+#ifdef RCREADER_DEFERRED_DECODE
+TEST(statsImpossibleTransitions)
+{
+    RCReader reader(RCR_PIN_A8);
+    SignalGenerator generator;
+    generator.addPWM(RCR_PIN_A8, 1500, 2000, OFFSET);
+    //lose edges in a queue overflow. The port is resynced with the next rising edge, so the reader does not see it
+    //and the falling edge after it is a transition to the level the reader already had.
+    generator.run(RCREADER_EDGE_QUEUE_SIZE * 1000 + 1800);
+    RCReader::poll();
+    generator.setEdgeHook(testEdgeHook);
+    generator.run(4000);
+
+    RCRReaderStats stats;
+    reader.getStats(&stats);
+    CHECK(stats.impossibleTransitions >= 1);
+}
+#endif
+#endif
@@ -0,0 +1,35 @@
+#ifndef TESTFRAMEWORK_H_
+#define TESTFRAMEWORK_H_
+
+#include <stdio.h>
+#include "SimulationHAL.h"
+
+//Minimal test runner without dependencies. Every TEST registers itself and is run by TestMain.cpp on a freshly reset simulation.
+
+struct _TestCase
+{
+    const char* name;
+    void (*function)(void);
+    _TestCase* next;
+};
+
+void _registerTest(_TestCase* test);
+void _reportFailure(const char* file, int line, const char* expression, long expected, long actual);
+
+//Called after every edge of a SignalGenerator by the tests, decodes queued edges in deferred mode
+void testEdgeHook();
+
+#define TEST(name) \
+    static void name(); \
+    static _TestCase _test_##name = {#name, name, NULL}; \
+    static struct _TestRegistrar_##name { _TestRegistrar_##name() { _registerTest(&_test_##name); } } _testRegistrar_##name; \
+    static void name()
+
+#define CHECK(condition) \
+    do { if(!(condition)) { _reportFailure(__FILE__, __LINE__, #condition, 1, 0); return; } } while(0)
+
+#define CHECK_EQUAL(expected, actual) \
+    do { long _e = (long)(expected); long _a = (long)(actual); \
+         if(_e != _a) { _reportFailure(__FILE__, __LINE__, #actual, _e, _a); return; } } while(0)
+
+#endif
@@ -0,0 +1,42 @@
+#include "TestFramework.h"
+#include "RCReader.h"
+
+static _TestCase* _firstTest = NULL;
+static _TestCase** _lastTest = &_firstTest;
+static bool _currentFailed;
+
+void _registerTest(_TestCase* test)
+{
+    //keep the order of the source file
+    *_lastTest = test;
+    _lastTest = &test->next;
+}
+
+void _reportFailure(const char* file, int line, const char* expression, long expected, long actual)
+{
+    printf("    %s:%d: %s: expected %ld, got %ld\n", file, line, expression, expected, actual);
+    _currentFailed = true;
+}
+
+void testEdgeHook()
+{
+    RCReader::poll();
+}
+
+int main()
+{
+    int failed = 0;
+    int count = 0;
+    for(_TestCase* test = _firstTest; test != NULL; test = test->next)
+    {
+        simReset();
+        _currentFailed = false;
+        test->function();
+        RCReader::poll(); //leave no queued edges behind for the next test
+        printf("[%s] %s\n", _currentFailed ? "FAIL" : " OK ", test->name);
+        failed += _currentFailed ? 1 : 0;
+        count++;
+    }
+    printf("%d of %d tests passed\n", count - failed, count);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,331 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SimulationHAL.h"
+#include "RCReader.h"
+
+//Replays a trace recorded with RCReader::dumpTrace through the decoding logic of the library and prints the decoded values.
+//The library is built for the host with the mocked AVR core of extras/simulation, see README.md for the trace format.
+
+#define TRACE_HEADER_SIZE 16
+#define TRACE_RECORD_SIZE 4
+#define TRACE_PAUSE 0x0F
+#define TRACE_WRAPPED 0x01
+
+static const RCReaderPin _allPins[] = {RCR_PIN_53, RCR_PIN_52, RCR_PIN_51, RCR_PIN_50, RCR_PIN_10, RCR_PIN_11, RCR_PIN_12, RCR_PIN_13,
+                                       RCR_PIN_0, RCR_PIN_15, RCR_PIN_14,
+                                       RCR_PIN_A8, RCR_PIN_A9, RCR_PIN_A10, RCR_PIN_A11, RCR_PIN_A12, RCR_PIN_A13, RCR_PIN_A14, RCR_PIN_A15};
+#define NUM_OF_PINS (sizeof(_allPins) / sizeof(_allPins[0]))
+
+//Statistics of one decoded channel
+struct ChannelStats
+{
+    uint32_t count;
+    uint16_t minimum;
+    uint16_t maximum;
+    uint64_t sum;
+    uint32_t lastTime;
+    uint32_t minimumInterval;
+    uint32_t maximumInterval;
+};
+
+//One pin that is replayed, either as PWM or as PPM signal
+struct ReplayChannel
+{
+    RCReaderPin pin;
+    RCReader* reader;
+    RCReaderPPM* ppm;
+    uint16_t lastFrame;
+    ChannelStats stats[RCREADER_PPM_MAX_CHANNELS];
+};
+
+static void _usage(const char* name)
+{
+    fprintf(stderr,
+        "usage: %s [options] trace.bin\n"
+        "  --pins <list>       comma separated pins to decode as PWM, e.g. A8,A9,53. Default: all pins that changed in the trace\n"
+        "  --ppm <pin>         decode the pin as PPM sum signal\n"
+        "  --filter <mode>     median3 or median5 filter for all PWM pins\n"
+        "  --max-delta <us>    spike rejection of the filter for all PWM pins\n"
+        "The decoded values are written as CSV to stdout, statistics per channel to stderr.\n", name);
+    exit(2);
+}
+
+static bool _parsePin(const char* name, RCReaderPin* pin)
+{
+    int number = (name[0] == 'A' || name[0] == 'a') ? A8 + atoi(name + 1) - 8 : atoi(name);
+    for(RCReaderPin candidate : _allPins)
+    {
+        if(candidate == number)
+        {
+            *pin = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void _pinName(RCReaderPin pin, char* name)
+{
+    if(pin >= A8)
+    {
+        sprintf(name, "A%d", pin - A8 + 8);
+    } else
+    {
+        sprintf(name, "%d", pin);
+    }
+}
+
+static void _addSample(ChannelStats* stats, uint16_t value, uint32_t time)
+{
+    if(stats->count == 0)
+    {
+        stats->minimum = stats->maximum = value;
+        stats->minimumInterval = 0xFFFFFFFF;
+        stats->maximumInterval = 0;
+    } else
+    {
+        uint32_t interval = time - stats->lastTime;
+        stats->minimumInterval = (interval < stats->minimumInterval) ? interval : stats->minimumInterval;
+        stats->maximumInterval = (interval > stats->maximumInterval) ? interval : stats->maximumInterval;
+    }
+    stats->minimum = (value < stats->minimum) ? value : stats->minimum;
+    stats->maximum = (value > stats->maximum) ? value : stats->maximum;
+    stats->sum += value;
+    stats->count++;
+    stats->lastTime = time;
+}
+
+static void _printSample(const char* pinName, uint8_t channel, uint16_t value, uint32_t time, const ChannelStats* stats)
+{
+    printf("%u,%s,%u,%u,", time, pinName, channel, value);
+    if(stats->count > 0)
+    {
+        printf("%u\n", time - stats->lastTime);
+    } else
+    {
+        printf("\n");
+    }
+}
+
+static void _printStats(const char* pinName, uint8_t channel, const ChannelStats* stats)
+{
+    if(stats->count == 0)
+    {
+        fprintf(stderr, "%-4s ch %2u: no values\n", pinName, channel);
+        return;
+    }
+    fprintf(stderr, "%-4s ch %2u: %6u values, width min %u avg %u max %u jitter %uus, interval min %u max %uus\n",
+            pinName, channel, stats->count, stats->minimum, (unsigned)(stats->sum / stats->count), stats->maximum,
+            stats->maximum - stats->minimum,
+            stats->count > 1 ? stats->minimumInterval : 0, stats->count > 1 ? stats->maximumInterval : 0);
+}
+
+int main(int argc, char** argv)
+{
+    const char* tracePath = NULL;
+    const char* pinList = NULL;
+    const char* ppmPinName = NULL;
+    RCRFilterMode filter = RCR_FILTER_NONE;
+    uint16_t maxDelta = 0;
+    for(int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--pins") == 0 && i + 1 < argc)
+        {
+            pinList = argv[++i];
+        } else if(strcmp(argv[i], "--ppm") == 0 && i + 1 < argc)
+        {
+            ppmPinName = argv[++i];
+        } else if(strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            i++;
+            filter = (strcmp(argv[i], "median3") == 0) ? RCR_FILTER_MEDIAN3 : (strcmp(argv[i], "median5") == 0) ? RCR_FILTER_MEDIAN5 : RCR_FILTER_NONE;
+        } else if(strcmp(argv[i], "--max-delta") == 0 && i + 1 < argc)
+        {
+            maxDelta = atoi(argv[++i]);
+        } else if(argv[i][0] != '-' && tracePath == NULL)
+        {
+            tracePath = argv[i];
+        } else
+        {
+            _usage(argv[0]);
+        }
+    }
+    if(tracePath == NULL)
+    {
+        _usage(argv[0]);
+    }
+
+    //read the whole trace
+    FILE* file = fopen(tracePath, "rb");
+    if(file == NULL)
+    {
+        fprintf(stderr, "can not open %s\n", tracePath);
+        return 1;
+    }
+    static uint8_t trace[TRACE_HEADER_SIZE + 0x10000 * TRACE_RECORD_SIZE];
+    size_t size = fread(trace, 1, sizeof(trace), file);
+    fclose(file);
+    if(size < TRACE_HEADER_SIZE || memcmp(trace, "RCRT", 4) != 0 || trace[4] != 1)
+    {
+        fprintf(stderr, "%s is not a RCReader trace of version 1\n", tracePath);
+        return 1;
+    }
+    uint8_t ticksPerMicrosecond = trace[5];
+    uint8_t flags = trace[6];
+    uint16_t recordCount = trace[8] | (trace[9] << 8);
+    uint16_t dropped = trace[10] | (trace[11] << 8);
+    const uint8_t* records = &trace[TRACE_HEADER_SIZE];
+    if(ticksPerMicrosecond == 0 || size < TRACE_HEADER_SIZE + (size_t)recordCount * TRACE_RECORD_SIZE)
+    {
+        fprintf(stderr, "%s is truncated\n", tracePath);
+        return 1;
+    }
+    fprintf(stderr, "%u records, %u dropped%s\n", recordCount, dropped, (flags & TRACE_WRAPPED) ? ", oldest records were overwritten" : "");
+
+    //state of the ports before the first record. If the start was overwritten, the first record of each port is used instead
+    uint8_t portStates[3] = {trace[12], trace[13], trace[14]};
+    uint8_t lastStates[3] = {trace[12], trace[13], trace[14]};
+    uint8_t changedPins[3] = {0, 0, 0};
+    bool portSeen[3] = {false, false, false};
+    for(uint16_t i = 0; i < recordCount; i++)
+    {
+        uint8_t port = records[i * TRACE_RECORD_SIZE + 2];
+        uint8_t pinStates = records[i * TRACE_RECORD_SIZE + 3];
+        if(port > 2)
+        {
+            continue;
+        }
+        if(!portSeen[port] && (flags & TRACE_WRAPPED) != 0)
+        {
+            portStates[port] = lastStates[port] = pinStates;
+        }
+        changedPins[port] |= pinStates ^ lastStates[port];
+        lastStates[port] = pinStates;
+        portSeen[port] = true;
+    }
+    simReset();
+    for(uint8_t port = 0; port < 3; port++)
+    {
+        simSetPortState(port, portStates[port]);
+    }
+
+    //create the readers after the initial state was set, like they would be on the board
+    ReplayChannel channels[NUM_OF_PINS];
+    uint8_t channelCount = 0;
+    RCReaderPin ppmPin = (RCReaderPin)255;
+    if(ppmPinName != NULL && !_parsePin(ppmPinName, &ppmPin))
+    {
+        fprintf(stderr, "unknown pin %s\n", ppmPinName);
+        return 2;
+    }
+    for(RCReaderPin pin : _allPins)
+    {
+        bool selected;
+        if(pinList != NULL)
+        {
+            selected = false;
+            char list[256];
+            strncpy(list, pinList, sizeof(list) - 1);
+            list[sizeof(list) - 1] = '\0';
+            for(char* name = strtok(list, ","); name != NULL; name = strtok(NULL, ","))
+            {
+                RCReaderPin listed;
+                if(!_parsePin(name, &listed))
+                {
+                    fprintf(stderr, "unknown pin %s\n", name);
+                    return 2;
+                }
+                selected = selected || listed == pin;
+            }
+        } else
+        {
+            uint8_t port = _RCReaderPinToPort(pin);
+            selected = port < 3 && (changedPins[port] & _RCReaderPinStateMask(pin)) != 0;
+        }
+        if(!selected && pin != ppmPin)
+        {
+            continue;
+        }
+        ReplayChannel* channel = &channels[channelCount++];
+        memset(channel, 0, sizeof(*channel));
+        channel->pin = pin;
+        if(pin == ppmPin)
+        {
+            channel->ppm = new RCReaderPPM(pin);
+        } else
+        {
+            channel->reader = new RCReader(pin);
+#ifdef RCREADER_ENABLE_FILTERS
+            channel->reader->setFilter(filter, maxDelta);
+#endif
+        }
+    }
+
+    printf("time_us,pin,channel,value_us,interval_us\n");
+    uint64_t ticks = 0;
+    for(uint16_t i = 0; i < recordCount; i++)
+    {
+        const uint8_t* record = &records[i * TRACE_RECORD_SIZE];
+        uint16_t delta = record[0] | (record[1] << 8);
+        uint8_t port = record[2];
+        if(port == TRACE_PAUSE)
+        {
+            ticks += (uint64_t)delta << 16;
+            continue;
+        }
+        if(port > 2)
+        {
+            fprintf(stderr, "invalid record %u\n", i);
+            return 1;
+        }
+        //the delta of the first record is relative to the start of the recording, which is not known if the trace wrapped
+        if(i > 0 || (flags & TRACE_WRAPPED) == 0)
+        {
+            ticks += delta;
+        }
+        uint32_t time = ticks / ticksPerMicrosecond;
+        simSetMicros(time);
+        simSetPortState(port, record[3]);
+        simFirePCINT(port);
+        RCReader::poll();
+
+        for(uint8_t c = 0; c < channelCount; c++)
+        {
+            ReplayChannel* channel = &channels[c];
+            char pinName[12];
+            _pinName(channel->pin, pinName);
+            if(channel->reader != NULL && channel->reader->hasNewValue())
+            {
+                uint16_t value;
+                channel->reader->getMicroseconds(&value);
+                _printSample(pinName, 0, value, time, &channel->stats[0]);
+                _addSample(&channel->stats[0], value, time);
+            } else if(channel->ppm != NULL && channel->ppm->getFrameCounter() != channel->lastFrame)
+            {
+                channel->lastFrame = channel->ppm->getFrameCounter();
+                for(uint8_t ppmChannel = 0; ppmChannel < channel->ppm->getChannelCount(); ppmChannel++)
+                {
+                    uint16_t value;
+                    channel->ppm->getMicroseconds(ppmChannel, &value);
+                    _printSample(pinName, ppmChannel, value, time, &channel->stats[ppmChannel]);
+                    _addSample(&channel->stats[ppmChannel], value, time);
+                }
+            }
+        }
+    }
+
+    for(uint8_t c = 0; c < channelCount; c++)
+    {
+        char pinName[12];
+        _pinName(channels[c].pin, pinName);
+        uint8_t count = (channels[c].ppm != NULL) ? channels[c].ppm->getChannelCount() : 1;
+        for(uint8_t channel = 0; channel < count || channel == 0; channel++)
+        {
+            _printStats(pinName, channel, &channels[c].stats[channel]);
+        }
+        delete channels[c].reader;
+        delete channels[c].ppm;
+    }
+    return 0;
+}